@@ -0,0 +1,154 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of per-report loginsert calls versus binary COPY
+ *         into a staging table with a bulk merge.
+ *
+ * Usage: copy.bench <conn_str> <tracker_id> [n] [batch]
+ *
+ * Reports are committed into the log, so run it against a test database.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pqxx/pqxx>
+
+#include <ys/db/pool.h>
+#include <ys/td/copier.h>
+
+namespace
+{
+
+/*!
+ * A typedef for a batch of reports with resolved tracker ids.
+ */
+using batch_type = std::vector<ys::td::copier::row_type>;
+
+/*!
+ * Save `n` reports in batches with `fn` and print the timing.
+ * \param title Benchmark title.
+ * \param batch Batch of reports.
+ * \param n Number of reports.
+ * \param fn Function saving a batch.
+ */
+template<typename Fn>
+void
+measure(char const* title, batch_type const& batch, int n, Fn fn)
+{
+    /*
+     * Warm up the connection and the statements.
+     */
+    fn(batch);
+
+    int saved = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (saved < n)
+    {
+        fn(batch);
+        saved += batch.size();
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << title << ": " << saved << " reports, " <<
+              ns / saved << "ns per report" << std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] <<
+                  " <conn_str> <tracker_id> [n] [batch]" << std::endl;
+        return 1;
+    }
+
+    std::string conn_str = argv[1];
+    uint32_t id = std::strtoul(argv[2], nullptr, 10);
+    int n = argc > 3 ? std::atoi(argv[3]) : 100000;
+    int size = argc > 4 ? std::atoi(argv[4]) : 500;
+
+    batch_type batch;
+
+    for (int i = 0; i < size; ++i)
+    {
+        ys::td::report d;
+
+        d.datetime = 1476532800 + i;
+        d.lon = 37478519;
+        d.lat = 55780104;
+        d.speed = 60;
+        d.odometer = 1000;
+        d.course = 90;
+        d.sats_glonass = 8;
+        d.sats_gps = 9;
+
+        batch.emplace_back(id, d);
+    }
+
+    ys::db::pool db { { conn_str } };
+
+    db.prepare("loginsert",
+               "select trackers.loginsert($1, "
+               "to_timestamp($2) at time zone 'UTC', "
+               "$3 / 1000000.0, $4 / 1000000.0, "
+               "$5, $6, $7, $8, $9)");
+
+    pqxx::connection_base& conn = *db[0];
+
+    measure("loginsert, prepared", batch, n, [&conn](batch_type const& b)
+    {
+        pqxx::work tx { conn };
+
+        for (auto& row: b)
+        {
+            ys::td::report const& d = row.second;
+
+            tx.prepared("loginsert")
+                (row.first)(d.datetime)(d.lon)(d.lat)
+                (static_cast<uint32_t>(d.speed))(d.odometer)
+                (static_cast<int32_t>(d.course))
+                (static_cast<uint32_t>(d.sats_glonass))
+                (static_cast<uint32_t>(d.sats_gps))
+                .exec();
+        }
+
+        tx.commit();
+    });
+
+    ys::td::copier merge
+    {
+        conn_str,
+        "select trackers.loginsert(id, datetime, lon, lat, speed, "
+        "odometer, course, sats_glonass, sats_gps) "
+        "from ys_td_staging order by n"
+    };
+
+    measure("copy and merge", batch, n, [&merge](batch_type const& b)
+    {
+        merge.save(b.data(), b.data() + b.size());
+    });
+
+    /*
+     * The staging cost alone, rows are discarded on commit.
+     */
+    ys::td::copier copy { conn_str, "select 1" };
+
+    measure("copy only", batch, n, [&copy](batch_type const& b)
+    {
+        copy.save(b.data(), b.data() + b.size());
+    });
+
+    return 0;
+}
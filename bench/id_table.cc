@@ -0,0 +1,108 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of tracker id lookups, std::map versus id_table.
+ *
+ * Usage: id_table.bench [trackers] [lookups]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ys/td/id_table.h>
+
+namespace
+{
+
+/*!
+ * Run `fn` for every tracker number in `order` and print the timing.
+ * \param title Benchmark title.
+ * \param order Tracker numbers in lookup order.
+ * \param fn Lookup function returning a tracker id.
+ */
+template<typename Fn>
+void
+measure(char const* title, std::vector<std::string> const& order, Fn fn)
+{
+    uint64_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto& num: order)
+    {
+        sum += fn(num);
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << title << ": " << order.size() << " lookups, " <<
+              ns / order.size() << "ns per lookup (checksum " << sum << ")" <<
+              std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::size_t trackers = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::size_t lookups = argc > 2 ? std::atoi(argv[2]) : 10000000;
+
+    const std::string type = "st270";
+
+    std::vector<std::string> nums;
+
+    for (std::size_t i = 0; i < trackers; ++i)
+    {
+        nums.push_back(std::to_string(205000000 + i * 7));
+    }
+
+    /*
+     * Fill both containers with the same trackers.
+     */
+
+    std::map<std::string, uint32_t> map;
+    ys::td::id_table table;
+
+    for (std::size_t i = 0; i < trackers; ++i)
+    {
+        map.insert({ nums[i] + ':' + type, i + 1 });
+
+        table.insert({ nums[i].data(), nums[i].size(), 0, false })->id = i + 1;
+    }
+
+    /*
+     * Look trackers up in a random order, as reports arrive.
+     */
+
+    std::mt19937 rnd { 42 };
+    std::uniform_int_distribution<std::size_t> dist { 0, trackers - 1 };
+    std::vector<std::string> order;
+
+    order.reserve(lookups);
+
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        order.push_back(nums[dist(rnd)]);
+    }
+
+    measure("std::map", order, [&map, &type](std::string const& num)
+    {
+        return map.find(num + ':' + type)->second;
+    });
+
+    measure("id_table", order, [&table](std::string const& num)
+    {
+        return table.find({ num.data(), num.size(), 0, false })->id;
+    });
+
+    return 0;
+}
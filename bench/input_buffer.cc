@@ -0,0 +1,125 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of splitting a burst of ST270 reports into lines,
+ *         vector front-erase versus input_buffer.
+ *
+ * Usage: input_buffer.bench [burst_kb] [read_size] [rounds]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ys/td/input_buffer.h>
+
+namespace
+{
+
+/*!
+ * Load the burst in reads of `read_size` bytes and consume every complete
+ * line after each read, print the timing.
+ * \param title Benchmark title.
+ * \param burst Burst bytes.
+ * \param read_size Read size.
+ * \param rounds Number of bursts.
+ * \param buffer Buffer to split the burst in.
+ * \param append Function appending a range to the buffer.
+ * \param consume Function dropping bytes up to an iterator.
+ */
+template<typename Buffer, typename Append, typename Consume>
+void
+measure(char const* title, std::string const& burst, std::size_t read_size,
+        std::size_t rounds, Buffer& buffer, Append append, Consume consume)
+{
+    std::size_t lines = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t r = 0; r < rounds; ++r)
+    {
+        for (std::size_t i = 0; i < burst.size(); i += read_size)
+        {
+            auto first = burst.begin() + i;
+
+            append(first, first + std::min(read_size, burst.size() - i));
+
+            for (;;)
+            {
+                auto it = std::find(buffer.begin(), buffer.end(), '\r');
+
+                if (it == buffer.end())
+                    break;
+
+                consume(std::next(it));
+                ++lines;
+            }
+        }
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << title << ", " << read_size << " byte reads: " <<
+              lines << " lines, " << ns / lines << "ns per line" <<
+              std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::size_t burst_kb = argc > 1 ? std::atoi(argv[1]) : 64;
+    std::size_t read_size = argc > 2 ? std::atoi(argv[2]) : 65536;
+    std::size_t rounds = argc > 3 ? std::atoi(argv[3]) : 100;
+
+    /*
+     * A black box backlog sent by a tracker after a coverage gap.
+     */
+    const std::string line =
+        "ST270STT;205000001;04;1097B;20161118;12:00:00;33e33;"
+        "+37.478628;+126.886030;000.012;000.00;9;1;0;15.30;001100;"
+        "1;0072;0;0;0;0;0;1;0\r";
+
+    std::string burst;
+
+    while (burst.size() + line.size() <= burst_kb * 1024)
+        burst += line;
+
+    {
+        std::vector<uint8_t> buffer;
+
+        measure("vector", burst, read_size, rounds, buffer,
+                [&buffer](std::string::const_iterator first,
+                          std::string::const_iterator last)
+        {
+            buffer.insert(buffer.end(), first, last);
+        },
+        [&buffer](std::vector<uint8_t>::iterator it)
+        {
+            buffer.erase(buffer.begin(), it);
+        });
+    }
+
+    {
+        ys::td::input_buffer buffer;
+
+        measure("input_buffer", burst, read_size, rounds, buffer,
+                [&buffer](std::string::const_iterator first,
+                          std::string::const_iterator last)
+        {
+            buffer.append(first, last);
+        },
+        [&buffer](ys::td::input_buffer::iterator it)
+        {
+            buffer.consume(it);
+        });
+    }
+
+    return 0;
+}
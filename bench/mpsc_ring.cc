@@ -0,0 +1,130 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of worker to saver handoff, the mutex guarded
+ *         lane_queue versus mpsc_ring, with a varying number of producers.
+ *
+ * Usage: mpsc_ring.bench [items] [max_producers]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <ys/td/lane_queue.h>
+#include <ys/td/mpsc_ring.h>
+
+namespace
+{
+
+/*!
+ * A report-sized item.
+ */
+struct item
+{
+    uint64_t seq;
+    char payload[56];
+};
+
+/*!
+ * Push `n` items from each of `producers` threads and drain them
+ * in batches, print the throughput.
+ * \param title Benchmark title.
+ * \param producers Number of producer threads.
+ * \param n Number of items per producer.
+ * \param push Function pushing one item.
+ * \param pop Function draining a batch of items.
+ */
+template<typename Push, typename Pop>
+void
+measure(char const* title, int producers, std::size_t n, Push push, Pop pop)
+{
+    std::vector<std::thread> threads;
+    std::vector<item> batch;
+    std::size_t total = producers * n;
+    std::size_t received = 0;
+
+    batch.reserve(256);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&push, n]()
+        {
+            item it {};
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                it.seq = i;
+                push(it);
+            }
+        });
+    }
+
+    while (received < total)
+    {
+        pop(batch);
+        received += batch.size();
+        batch.clear();
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    for (auto& t: threads)
+    {
+        t.join();
+    }
+
+    std::cout << title << ", " << producers << " producers: " <<
+              ns / total << "ns per item" << std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::size_t items = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    int max_producers = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    for (int p = 1; p <= max_producers; p *= 2)
+    {
+        std::size_t n = items / p;
+
+        {
+            ys::td::lane_queue<item> q;
+
+            measure("lane_queue", p, n, [&q](item const& it)
+            {
+                q.push(ys::td::lane::live, &it, &it + 1);
+            },
+            [&q](std::vector<item>& out)
+            {
+                ys::td::lane l;
+
+                q.pop(out, 256, 256, std::chrono::milliseconds {}, l);
+            });
+        }
+
+        {
+            ys::td::mpsc_ring<item> q { 65536 };
+
+            measure("mpsc_ring", p, n, [&q](item const& it)
+            {
+                while (!q.push(it))
+                    std::this_thread::yield();
+            },
+            [&q](std::vector<item>& out)
+            {
+                q.pop(out, 256, std::chrono::milliseconds { 100 });
+            });
+        }
+    }
+
+    return 0;
+}
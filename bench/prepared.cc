@@ -0,0 +1,134 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of string-built versus prepared saver statements.
+ *
+ * Usage: prepared.bench <conn_str> <tracker_id> <tracker_num> <type> [n]
+ *
+ * All statements run in transactions which are rolled back, so nothing
+ * is left in the database.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <pqxx/pqxx>
+
+#include <ys/db/pool.h>
+
+namespace
+{
+
+/*!
+ * Sample report values.
+ */
+const std::string datetime = "2016-10-15 12:00:00";
+const double lon = 37.478519;
+const double lat = 55.780104;
+
+/*!
+ * Run `fn` `n` times in a rolled back transaction.
+ * \param title Benchmark title.
+ * \param conn Database connection.
+ * \param n Number of iterations.
+ * \param fn Function to run.
+ */
+template<typename Fn>
+void
+measure(char const* title, pqxx::connection_base& conn, int n, Fn fn)
+{
+    pqxx::work tx { conn };
+
+    /*
+     * Warm up the connection and the statement.
+     */
+    fn(tx);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < n; ++i)
+    {
+        fn(tx);
+    }
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << title << ": " << n << " calls, " <<
+              us / n << "us per call" << std::endl;
+
+    tx.abort();
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    if (argc < 5)
+    {
+        std::cerr << "Usage: " << argv[0] <<
+                  " <conn_str> <tracker_id> <tracker_num> <type> [n]" <<
+                  std::endl;
+        return 1;
+    }
+
+    uint32_t id = std::strtoul(argv[2], nullptr, 10);
+    std::string num = argv[3];
+    std::string type = argv[4];
+    int n = argc > 5 ? std::atoi(argv[5]) : 10000;
+
+    ys::db::pool db { { argv[1] } };
+
+    db.prepare("loginsert",
+               "select trackers.loginsert($1, $2, $3, $4, $5, $6, $7, $8, $9)");
+
+    db.prepare("tracker_id_by_num",
+               "select id from trackers.trackers where "
+               "num = $1 and "
+               "typeid = "
+               "(select id from trackers.types where name = $2)");
+
+    pqxx::connection_base& conn = *db[0];
+
+    measure("loginsert, string", conn, n, [&](pqxx::work& tx)
+    {
+        tx.exec("select trackers.loginsert(" +
+                tx.quote(id) + ", " +
+                tx.quote(datetime) + ", " +
+                tx.quote(lon) + ", " +
+                tx.quote(lat) + ", " +
+                tx.quote(60u) + ", " +
+                tx.quote(1000u) + ", " +
+                tx.quote(90) + ", " +
+                tx.quote(8u) + ", " +
+                tx.quote(9u) + ")"
+               );
+    });
+
+    measure("loginsert, prepared", conn, n, [&](pqxx::work& tx)
+    {
+        tx.prepared("loginsert")
+            (id)(datetime)(lon)(lat)(60u)(1000u)(90)(8u)(9u)
+            .exec();
+    });
+
+    measure("lookup by num, string", conn, n, [&](pqxx::work& tx)
+    {
+        tx.exec("select id from trackers.trackers where "
+                "num = " + tx.quote(num) + " and "
+                "typeid = "
+                "(select id from trackers.types where "
+                "name = " + tx.quote(type) + ")");
+    });
+
+    measure("lookup by num, prepared", conn, n, [&](pqxx::work& tx)
+    {
+        tx.prepared("tracker_id_by_num")(num)(type).exec();
+    });
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of shared tracker id lookups, a mutex guarded id_table
+ *         versus tracker_registry, with a varying number of readers.
+ *
+ * Usage: registry.bench [trackers] [lookups] [w_count]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ys/td/id_table.h>
+#include <ys/td/tracker_registry.h>
+
+namespace
+{
+
+/*!
+ * Run `n` random lookups in each of `readers` threads while the table
+ * is republished every 10ms, print the throughput.
+ * \param title Benchmark title.
+ * \param readers Number of reader threads.
+ * \param nums Tracker numbers.
+ * \param n Number of lookups per reader.
+ * \param make Function making a per-thread lookup function.
+ * \param publish Function replacing the table.
+ */
+template<typename Make, typename Publish>
+void
+measure(char const* title, int readers, std::vector<std::string> const& nums,
+        std::size_t n, Make make, Publish publish)
+{
+    std::vector<std::thread> threads;
+    std::atomic<int> running { readers };
+    std::atomic<uint64_t> sum { 0 };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&, r]()
+        {
+            auto find = make();
+            std::mt19937 rnd ( r );
+            std::uniform_int_distribution<std::size_t> dist
+            {
+                0, nums.size() - 1
+            };
+            uint64_t s = 0;
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto& num = nums[dist(rnd)];
+
+                s += find({ num.data(), num.size(), 0, false });
+            }
+
+            sum += s;
+            --running;
+        });
+    }
+
+    /*
+     * The writer keeps publishing while the readers run, as the saver
+     * does with resolved ids.
+     */
+    std::size_t published = 0;
+
+    while (running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+        publish();
+        ++published;
+    }
+
+    for (auto& t: threads)
+    {
+        t.join();
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << title << ", " << readers << " readers: " <<
+              ns / n << "ns per lookup per reader, " <<
+              readers * n * 1000000 / ns << "K lookups/s, " <<
+              published << " publications (checksum " << sum << ")" <<
+              std::endl;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    std::size_t trackers = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::size_t lookups = argc > 2 ? std::atoi(argv[2]) : 4000000;
+    int w_count = argc > 3 ? std::atoi(argv[3]) :
+                  std::thread::hardware_concurrency();
+
+    std::vector<std::string> nums;
+    ys::td::id_table table;
+
+    for (std::size_t i = 0; i < trackers; ++i)
+    {
+        nums.push_back(std::to_string(205000000 + i * 7));
+
+        table.insert({ nums[i].data(), nums[i].size(), 0, false })->id = i + 1;
+    }
+
+    for (int r = 1; r <= w_count; r *= 2)
+    {
+        {
+            std::mutex mutex;
+            ys::td::id_table shared { table };
+
+            measure("mutex", r, nums, lookups, [&mutex, &shared]()
+            {
+                return [&mutex, &shared](ys::td::id_table::key_type const& k)
+                {
+                    std::lock_guard<std::mutex> lock { mutex };
+                    return shared.find(k)->id;
+                };
+            },
+            [&mutex, &shared, &table]()
+            {
+                ys::td::id_table copy { table };
+                std::lock_guard<std::mutex> lock { mutex };
+                shared.swap(copy);
+            });
+        }
+
+        {
+            ys::td::tracker_registry registry { static_cast<std::size_t>(r) };
+
+            registry.publish(table);
+
+            measure("tracker_registry", r, nums, lookups, [&registry]()
+            {
+                /*
+                 * Every thread takes its own reader slot.
+                 */
+                auto reader = std::make_shared<
+                                  ys::td::tracker_registry::reader>(registry);
+
+                return [reader](ys::td::id_table::key_type const& k)
+                {
+                    ys::td::id_table::value_type v;
+                    reader->find(k, v);
+                    return v.id;
+                };
+            },
+            [&registry, &table]()
+            {
+                registry.publish(table);
+            });
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of memory per queued report, string-based record
+ *         versus the compact report.
+ *
+ * Usage: report_size.bench [reports]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <ys/td/report.h>
+
+namespace
+{
+
+/*!
+ * Number of heap allocations.
+ */
+std::atomic<std::size_t> allocs { 0 };
+
+/*!
+ * Number of allocated heap bytes.
+ */
+std::atomic<std::size_t> alloc_bytes { 0 };
+
+/*!
+ * Parsed data as it was kept before the compact report.
+ */
+struct legacy_report
+{
+    std::string phone;
+    std::string num;
+    std::string type;
+    std::string datetime;
+    double lon {};
+    double lat {};
+    double speed {};
+    uint32_t odometer {};
+    double course {};
+    uint32_t sats_glonass {};
+    uint32_t sats_gps {};
+};
+
+/*!
+ * Queue `n` copies of the report as the saver does and print the memory
+ * taken per report.
+ * \param title Benchmark title.
+ * \param d Report.
+ * \param n Number of reports.
+ */
+template<typename Report>
+void
+measure(char const* title, Report const& d, std::size_t n)
+{
+    std::size_t allocs_start = allocs;
+    std::size_t bytes_start = alloc_bytes;
+
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        std::deque<Report> queue;
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            queue.push_back(d);
+        }
+
+        std::size_t a = allocs - allocs_start;
+        std::size_t b = alloc_bytes - bytes_start;
+
+        std::cout << title << ": sizeof " << sizeof(Report) << ", " <<
+                  static_cast<double>(b) / n << " bytes and " <<
+                  static_cast<double>(a) / n << " allocations per report";
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << ", " << ns / n << "ns per report" << std::endl;
+}
+
+} // namespace
+
+/*!
+ * Counting allocation function.
+ * \param n
+ * \return
+ */
+void*
+operator new(std::size_t n)
+{
+    ++allocs;
+    alloc_bytes += n;
+
+    if (void* p = std::malloc(n))
+        return p;
+
+    throw std::bad_alloc {};
+}
+
+/*!
+ * Deallocation function matching the counting one.
+ * \param p
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::size_t reports = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    legacy_report legacy;
+
+    legacy.num = "205000123";
+    legacy.type = "st270";
+    legacy.datetime = "2016-10-15 12:00:00";
+    legacy.lon = 37.478424;
+    legacy.lat = 55.753215;
+    legacy.speed = 60.5;
+    legacy.odometer = 1000;
+    legacy.course = 90;
+    legacy.sats_glonass = 8;
+    legacy.sats_gps = 9;
+
+    ys::td::report compact;
+
+    compact.set_number(legacy.num);
+    compact.type = ys::td::type_registry::intern(legacy.type);
+    compact.datetime = 1476532800;
+    compact.lon = 37478424;
+    compact.lat = 55753215;
+    compact.speed = 60;
+    compact.odometer = 1000;
+    compact.course = 90;
+    compact.sats_glonass = 8;
+    compact.sats_gps = 9;
+
+    measure("strings", legacy, reports);
+    measure("report", compact, reports);
+
+    return 0;
+}
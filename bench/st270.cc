@@ -0,0 +1,222 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Benchmark of ST270 report parsing, string splitting versus
+ *         the tokenizer, with heap allocations counted.
+ *
+ * Usage: st270.bench [reports]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <locale>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/date_time.hpp>
+
+#include <ys/td/lib.h>
+#include <ys/td/st270_parser.h>
+
+namespace
+{
+
+/*!
+ * Number of heap allocations.
+ */
+std::atomic<uint64_t> allocations { 0 };
+
+/*!
+ * Get seconds since the epoch of a datetime string in `in_loc` format,
+ * the way the parser used to.
+ * \param dt
+ * \param in_loc
+ * \param epoch Output value.
+ * \return False if the string is not a valid datetime.
+ */
+bool
+parse_epoch(std::string const& dt, std::locale const& in_loc,
+            int64_t& epoch)
+{
+    std::istringstream is { dt };
+
+    is.imbue(in_loc);
+
+    boost::posix_time::ptime t;
+
+    is >> t;
+
+    if (t.is_special())
+        return false;
+
+    static const boost::posix_time::ptime epoch_start
+    {
+        boost::gregorian::date { 1970, 1, 1 }
+    };
+
+    epoch = (t - epoch_start).total_seconds();
+
+    return true;
+}
+
+/*!
+ * Parse a report splitting it into strings, as the parser used to.
+ * \param line Report line.
+ * \param in_loc Locale for reading datetime strings.
+ * \param d Output report.
+ * \return False if the report is not valid.
+ */
+bool
+split_report(std::string const& line, std::locale const& in_loc,
+             ys::td::report& d)
+{
+    auto v = split(line, ';');
+
+    if (v.size() < 26)
+        return false;
+
+    std::string hdr = v[0];
+
+    d.set_number(v[1]);
+
+    v.erase(v.begin(), std::next(v.begin(), 2));
+
+    std::string sw_ver, date, time, cell, lat, lon, spd, crs,
+        satt_gps, satt_glonass, fix, alt, pulse_in1, pulse_in2,
+        dist, pwr_volt, io, an1, an2, an3, an4, to, tf, vs;
+
+    vec2vars(v, sw_ver, date, time, cell, lat, lon, spd, crs,
+             satt_gps, satt_glonass, fix, alt, pulse_in1, pulse_in2,
+             dist, pwr_volt, io, an1, an2, an3, an4, to, tf, vs);
+
+    if (!parse_epoch(date + " " + time, in_loc, d.datetime))
+        return false;
+
+    d.lat = std::lround(parse_string<double>(lat) * 1000000);
+    d.lon = std::lround(parse_string<double>(lon) * 1000000);
+    d.speed = parse_string<double>(spd);
+    d.course = parse_string<double>(crs);
+    d.sats_gps = parse_string<int>(satt_gps);
+    d.sats_glonass = parse_string<int>(satt_glonass);
+    d.odometer = parse_string<int>(dist) / 1000;
+
+    return true;
+}
+
+/*!
+ * Get a checksum of the decoded report fields.
+ * \param d
+ * \return
+ */
+uint64_t
+checksum(ys::td::report const& d)
+{
+    return d.datetime + d.lat + d.lon + d.speed + d.course + d.sats_gps +
+           d.sats_glonass + d.odometer + d.number_size;
+}
+
+/*!
+ * Run `fn` for `n` reports and print the timing and allocations.
+ * \param title Benchmark title.
+ * \param n Number of reports.
+ * \param fn Function parsing a report and returning its checksum.
+ */
+template<typename Fn>
+void
+measure(char const* title, std::size_t n, Fn fn)
+{
+    uint64_t sum = 0;
+    uint64_t before = allocations;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        sum += fn();
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+
+    std::cout << title << ": " << n << " reports, " <<
+              ns / n << "ns per report, " <<
+              (allocations - before) / n << " allocations per report " <<
+              "(checksum " << sum << ")" << std::endl;
+}
+
+} // namespace
+
+/*!
+ * Count heap allocations.
+ * \param size
+ * \return
+ */
+void*
+operator new(std::size_t size)
+{
+    ++allocations;
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+/*!
+ * Free memory allocated by the counting `operator new`.
+ * \param p
+ */
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::size_t reports = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    const std::string line =
+        "ST270STT;205000001;1097B;20161119;12:00:00;33e33;"
+        "+37.478628;-126.886030;000.012;123.40;9;7;1;120;0;0;15300;12.5;"
+        "001100;0;0;0;0;0;1;0";
+
+    const std::locale in_loc
+    {
+        std::locale::classic(),
+        new boost::posix_time::time_input_facet("%Y%m%d %H:%M:%S")
+    };
+
+    measure("split", reports, [&line, &in_loc]()
+    {
+        ys::td::report d;
+
+        return split_report(line, in_loc, d) ? checksum(d) : 0;
+    });
+
+    /*
+     * The parser reads the report the way a connection delivers it.
+     */
+    ys::td::st270_parser parser;
+    const std::string packet = line + '\r';
+
+    measure("tokenizer", reports, [&parser, &packet]()
+    {
+        parser.load(packet, packet.size());
+
+        auto res = parser.parse();
+
+        parser.detach();
+
+        return res.parsed ? checksum(parser.data()) : 0;
+    });
+
+    return 0;
+}
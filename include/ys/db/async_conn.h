@@ -0,0 +1,257 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Non-blocking database connection class header file.
+ */
+
+#ifndef YS_DB_ASYNC_CONN_H
+#define YS_DB_ASYNC_CONN_H
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <libpq-fe.h>
+#include <sys/types.h>
+#include <ys/db/pool.h>
+
+namespace ys
+{
+namespace db
+{
+
+/*!
+ * A database connection driven by libpq non-blocking API on an asio
+ * event loop.
+ *
+ * The connection runs one statement at a time, its socket readiness is
+ * waited for by the event loop, so a single thread can keep many
+ * connections busy. Statements declared with `prepare` are prepared
+ * on every opened connection before it is handed to the open handler.
+ * All methods must be called from the event loop thread.
+ */
+class async_conn
+{
+public:
+    /*!
+     * A typedef for a completion handler, it gets no exception on success,
+     * `pqxx::broken_connection` when the connection is lost and
+     * `std::runtime_error` when the statement fails.
+     */
+    using handler_type = std::function<void(std::exception_ptr)>;
+
+    /*!
+     * A typedef for an open handler.
+     */
+    using open_handler_type = std::function<void()>;
+
+    /*!
+     * Constructor.
+     * \param io Event loop.
+     * \param conn_str Connection string.
+     * \param max_backoff Maximum delay between reconnection attempts.
+     */
+    async_conn(boost::asio::io_service& io, std::string const& conn_str,
+               std::chrono::milliseconds max_backoff);
+
+    /*!
+     * Destructor.
+     */
+    ~async_conn();
+
+    /*!
+     * Declare a prepared statement, it is prepared on the connection
+     * every time it is opened.
+     * \param name Statement name.
+     * \param definition Statement SQL with `$n` parameters.
+     */
+    void
+    prepare(std::string const& name, std::string const& definition);
+
+    /*!
+     * Open the connection, retrying with a growing delay until it succeeds
+     * or the connection is closed.
+     * \param handler Handler called once the connection is open.
+     */
+    void
+    open(open_handler_type handler);
+
+    /*!
+     * Close the connection and cancel pending operations, their handlers
+     * are not called.
+     */
+    void
+    close();
+
+    /*!
+     * Execute a prepared statement.
+     * \param name Statement name.
+     * \param params Parameters in the text format.
+     * \param handler Completion handler.
+     */
+    void
+    exec(std::string const& name, std::vector<std::string> const& params,
+         handler_type handler);
+
+    /*!
+     * Get health of the connection.
+     * \return
+     */
+    pool::health_type const&
+    health() const;
+
+private:
+    /*!
+     * Event loop.
+     */
+    boost::asio::io_service& io_;
+
+    /*!
+     * Connection string.
+     */
+    std::string conn_str_;
+
+    /*!
+     * Connection.
+     */
+    PGconn* conn_ { nullptr };
+
+    /*!
+     * Duplicate of the connection socket watched by the event loop.
+     */
+    boost::asio::posix::stream_descriptor socket_;
+
+    /*!
+     * Device of the socket the descriptor duplicates.
+     */
+    dev_t dev_ { 0 };
+
+    /*!
+     * Inode of the socket the descriptor duplicates.
+     */
+    ino_t ino_ { 0 };
+
+    /*!
+     * Reconnection timer.
+     */
+    boost::asio::steady_timer timer_;
+
+    /*!
+     * Delay before the next reconnection attempt.
+     */
+    std::chrono::milliseconds backoff_;
+
+    /*!
+     * Maximum delay between reconnection attempts.
+     */
+    std::chrono::milliseconds max_backoff_;
+
+    /*!
+     * Handler of the pending open.
+     */
+    open_handler_type on_open_;
+
+    /*!
+     * Handler of the pending statement.
+     */
+    handler_type on_done_;
+
+    /*!
+     * Error of the pending statement.
+     */
+    std::exception_ptr error_;
+
+    /*!
+     * Declared statements, names and definitions.
+     */
+    std::vector<std::pair<std::string, std::string>> statements_;
+
+    /*!
+     * Number of declared statements prepared on the connection.
+     */
+    std::size_t prepared_ { 0 };
+
+    /*!
+     * Number of closes, completions posted before a close are dropped.
+     */
+    unsigned generation_ { 0 };
+
+    /*!
+     * The connection was open before.
+     */
+    bool opened_ { false };
+
+    /*!
+     * Connection health.
+     */
+    pool::health_type health_;
+
+    /*!
+     * Start a connection attempt.
+     */
+    void
+    connect();
+
+    /*!
+     * Continue the connection attempt.
+     * \param status Status of the latest poll.
+     */
+    void
+    poll(PostgresPollingStatusType status);
+
+    /*!
+     * Prepare the next declared statement on the new connection, call
+     * the open handler once all of them are prepared.
+     */
+    void
+    declare();
+
+    /*!
+     * Schedule the next connection attempt.
+     */
+    void
+    retry();
+
+    /*!
+     * Send the pending statement to the server.
+     */
+    void
+    flush();
+
+    /*!
+     * Read results of the pending statement.
+     */
+    void
+    receive();
+
+    /*!
+     * Mark the connection broken and complete the pending statement.
+     */
+    void
+    fail();
+
+    /*!
+     * Complete the pending statement.
+     * \param e
+     */
+    void
+    complete(std::exception_ptr e);
+
+    /*!
+     * Wait for the socket to become readable or writable.
+     * \param write Wait for writability.
+     * \param handler
+     */
+    void
+    wait(bool write, std::function<void()> handler);
+};
+
+} // namespace db
+} // namespace ys
+
+#endif // YS_DB_ASYNC_CONN_H
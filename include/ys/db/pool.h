@@ -9,6 +9,10 @@
 #define YS_DB_POOL_H
 
 #include <pqxx/pqxx>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
 #include <vector>
 #include <string>
 #include <memory>
@@ -20,24 +24,173 @@ namespace db
 
 /*!
  * Class for a pool of pqxx connections.
+ *
+ * Connections are opened in parallel and the ones which fail to open or
+ * break later are reopened with an exponential backoff. A connection
+ * object lives as long as the pool, so its pointer stays valid across
+ * reconnects, and statements declared with `prepare` are prepared again
+ * on a reopened connection by pqxx.
+ *
+ * A connection and its reconnection are owned by a single thread, health
+ * counters may be read from any thread.
  */
-class pool: public std::vector<std::shared_ptr<pqxx::connection>>
+class pool: public std::vector<std::shared_ptr<pqxx::connection_base>>
 {
 public:
     /*!
      * Connection pointer typedef.
      */
-    using conn_ptr = std::shared_ptr<pqxx::connection>;
+    using conn_ptr = std::shared_ptr<pqxx::connection_base>;
 
     /*!
-     * Constructor.
+     * Clock typedef.
+     */
+    using clock_type = std::chrono::steady_clock;
+
+    /*!
+     * Connection health.
+     */
+    struct health_type
+    {
+        /*!
+         * The connection is open and has not failed since.
+         */
+        std::atomic<bool> healthy { false };
+
+        /*!
+         * Number of times the connection was found broken.
+         */
+        std::atomic<uint64_t> failures { 0 };
+
+        /*!
+         * Number of successful reconnects.
+         */
+        std::atomic<uint64_t> reconnects { 0 };
+
+        /*!
+         * Connection health output.
+         * \param os
+         * \param h
+         * \return
+         */
+        friend
+        std::ostream& operator<<(std::ostream& os, health_type const& h)
+        {
+            os <<
+                (h.healthy ? "healthy" : "broken") << ", " <<
+                "failures " << h.failures << ", " <<
+                "reconnects " << h.reconnects;
+
+            return os;
+        }
+    };
+
+    /*!
+     * Constructor, opens all connections in parallel.
      * \param conn_str A list of connection strings.
+     * \param max_backoff Maximum delay between reconnection attempts.
+     */
+    pool(std::vector<std::string> const& conn_str,
+         std::chrono::milliseconds max_backoff = std::chrono::seconds { 30 });
+
+    /*!
+     * Declare a prepared statement on every connection of the pool.
+     *
+     * The statement is parsed and planned by a server once per connection
+     * on its first execution.
+     *
+     * \param name Statement name.
+     * \param definition Statement SQL with `$n` parameters.
+     */
+    void
+    prepare(std::string const& name, std::string const& definition);
+
+    /*!
+     * Get a connection string of the connection.
+     * \param i Connection index.
+     * \return
+     */
+    std::string const&
+    conn_str(std::size_t i) const;
+
+    /*!
+     * Get health of the connection.
+     * \param i Connection index.
+     * \return
+     */
+    health_type const&
+    health(std::size_t i) const;
+
+    /*!
+     * Mark the connection broken, it is reopened by `reconnect`.
+     * \param i Connection index.
+     */
+    void
+    broken(std::size_t i);
+
+    /*!
+     * Reopen the connection if it is broken and the backoff delay
+     * has passed.
+     * \param i Connection index.
+     * \return True if the connection is healthy.
+     */
+    bool
+    reconnect(std::size_t i);
+
+private:
+    /*!
+     * Connection state.
+     */
+    struct state_type
+    {
+        /*!
+         * Connection health.
+         */
+        health_type health;
+
+        /*!
+         * Current delay between reconnection attempts.
+         */
+        std::chrono::milliseconds backoff;
+
+        /*!
+         * Time of the next reconnection attempt.
+         */
+        clock_type::time_point retry_time;
+    };
+
+    /*!
+     * Connection strings.
      */
-    pool(std::vector<std::string> const& conn_str);
+    std::vector<std::string> conn_str_;
+
+    /*!
+     * Connection states, indexed as connections.
+     */
+    std::vector<std::unique_ptr<state_type>> states_;
+
+    /*!
+     * Maximum delay between reconnection attempts.
+     */
+    std::chrono::milliseconds max_backoff_;
+
+    /*!
+     * Open the connection.
+     * \param i Connection index.
+     * \return True on success.
+     */
+    bool
+    open(std::size_t i);
+
+    /*!
+     * Schedule the next reconnection attempt.
+     * \param i Connection index.
+     */
+    void
+    backoff(std::size_t i);
 };
 
 } // namespace db
 } // namespace ys
 
 #endif // YS_DB_POOL_H
-
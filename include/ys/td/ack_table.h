@@ -0,0 +1,203 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Delivery tickets table header file.
+ */
+
+#ifndef YS_TD_ACK_TABLE_H
+#define YS_TD_ACK_TABLE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A table of delivery tickets of reports waiting to be committed.
+ *
+ * A worker opens a ticket for the reports of a read and holds the reply
+ * until the ticket is done. Every report of the ticket retains it, and
+ * the saver and writers release it once the report is committed, written
+ * to the spool and synced to disk, or is known to be never written.
+ * A retransmit is released at once only when its original is already
+ * committed, one whose original is still queued is saved again. The
+ * ticket handler is called by the thread dropping the last reference.
+ */
+class ack_table
+{
+public:
+    /*!
+     * A typedef for a ticket handler, it gets the done ticket.
+     */
+    using handler_type = std::function<void(uint32_t)>;
+
+    /*!
+     * Tickets statistics.
+     */
+    struct stats_type
+    {
+        /*!
+         * Number of done tickets.
+         */
+        std::atomic<uint64_t> done { 0 };
+
+        /*!
+         * Total time from opening to completion of done tickets
+         * in microseconds.
+         */
+        std::atomic<uint64_t> latency { 0 };
+
+        /*!
+         * Longest time from opening to completion in microseconds.
+         */
+        std::atomic<uint64_t> max_latency { 0 };
+
+        /*!
+         * Statistics output.
+         * \param os
+         * \param s
+         * \return
+         */
+        friend
+        std::ostream& operator<<(std::ostream& os, stats_type const& s)
+        {
+            uint64_t done = s.done;
+
+            os <<
+                "acks " << done << ", " <<
+                "avg ack " << (done ? s.latency / done : 0) << "us, " <<
+                "max ack " << s.max_latency << "us";
+
+            return os;
+        }
+    };
+
+    /*!
+     * Open a ticket holding one reference, which the opener releases.
+     * \param handler Handler called when the ticket is done.
+     * \return Ticket, never 0.
+     */
+    uint32_t
+    open(handler_type handler);
+
+    /*!
+     * Add references to the ticket.
+     * \param ticket
+     * \param n Number of references.
+     */
+    void
+    retain(uint32_t ticket, std::size_t n = 1);
+
+    /*!
+     * Drop references to the ticket, the handler is called when
+     * the last one is dropped.
+     * \param ticket Ticket, 0 is ignored.
+     * \param n Number of references.
+     */
+    void
+    release(uint32_t ticket, std::size_t n = 1);
+
+    /*!
+     * Drop a reference of every report of the range.
+     * \param first
+     * \param last
+     * \param get Function getting a report of a range item.
+     */
+    template<typename Iterator, typename Get>
+    void
+    release(Iterator first, Iterator last, Get get)
+    {
+        /*
+         * Reports of a read usually go together, their references are
+         * dropped at once.
+         */
+        while (first != last)
+        {
+            uint32_t ticket = get(*first).ack;
+            std::size_t n = 0;
+
+            for (; first != last && get(*first).ack == ticket; ++first)
+            {
+                ++n;
+            }
+
+            release(ticket, n);
+        }
+    }
+
+    /*!
+     * Get a number of open tickets.
+     * \return
+     */
+    std::size_t
+    size() const;
+
+    /*!
+     * Get tickets statistics.
+     * \return
+     */
+    stats_type const&
+    stats() const;
+
+private:
+    /*!
+     * Clock typedef.
+     */
+    using clock_type = std::chrono::steady_clock;
+
+    /*!
+     * Open ticket.
+     */
+    struct entry
+    {
+        /*!
+         * Number of references.
+         */
+        std::size_t refs;
+
+        /*!
+         * Opening time.
+         */
+        clock_type::time_point time;
+
+        /*!
+         * Handler.
+         */
+        handler_type handler;
+    };
+
+    /*!
+     * Open tickets.
+     */
+    std::unordered_map<uint32_t, entry> tickets_;
+
+    /*!
+     * The latest ticket.
+     */
+    uint32_t last_ { 0 };
+
+    /*!
+     * Access mutex.
+     */
+    mutable std::mutex mutex_;
+
+    /*!
+     * Tickets statistics.
+     */
+    stats_type stats_;
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_ACK_TABLE_H
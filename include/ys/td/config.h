@@ -9,6 +9,7 @@
 #define YS_TD_CONFIG_H
 
 #include <ys/config.h>
+#include <boost/property_tree/ptree.hpp>
 #include <vector>
 #include <string>
 #include <map>
@@ -43,6 +44,195 @@ public:
          * Name of the tracker type.
          */
         std::string type;
+
+        /*!
+         * Replies are sent once the reports they acknowledge
+         * are committed or synced to the spool, a tracker never gets
+         * a reply for a report lost on a crash of the host.
+         */
+        bool ack_commit;
+    };
+
+    /*!
+     * Structure describing a database shard.
+     */
+    struct db_shard
+    {
+        /*!
+         * Connection string.
+         */
+        std::string conn;
+
+        /*!
+         * Shard name, trackers are placed by names, the connection string
+         * is used when not set.
+         */
+        std::string name;
+
+        /*!
+         * Relative share of trackers, 0 takes no trackers.
+         */
+        unsigned weight { 1 };
+    };
+
+    /*!
+     * Structure describing saver settings.
+     */
+    struct saver_options
+    {
+        /*!
+         * Number of reports each saver queue holds, reports which fit
+         * neither a queue nor the spool are dropped.
+         */
+        std::size_t queue_size { 65536 };
+
+        /*!
+         * Number of reports each shard writer queue holds, reports
+         * of a shard falling behind go to the spool past it, or are
+         * dropped without a spool.
+         */
+        std::size_t writer_queue_size { 65536 };
+
+        /*!
+         * Maximum number of reports written in one transaction.
+         */
+        std::size_t batch_size { 1 };
+
+        /*!
+         * Time in milliseconds to wait for a batch to fill up.
+         */
+        int batch_wait { 0 };
+
+        /*!
+         * Interval in seconds between saver statistics reports,
+         * 0 disables reporting.
+         */
+        int stats_interval { 60 };
+
+        /*!
+         * Path to a tracker ids snapshot file, empty disables snapshots.
+         */
+        std::string id_snapshot;
+
+        /*!
+         * Interval in seconds between tracker ids snapshot refreshes.
+         */
+        int id_snapshot_interval { 300 };
+
+        /*!
+         * Time in seconds to remember trackers missing in a database.
+         */
+        int unknown_ttl { 300 };
+
+        /*!
+         * Maximum number of reports inserted with one array statement,
+         * a batch takes one round trip per chunk. 0 and 1 insert every
+         * report with a statement of its own.
+         */
+        std::size_t insert_chunk { 0 };
+
+        /*!
+         * Spool directory, empty disables spooling.
+         */
+        std::string spool;
+
+        /*!
+         * Size of a spool segment file in megabytes.
+         */
+        std::size_t spool_segment_size { 64 };
+
+        /*!
+         * Number of queued reports to start spooling at.
+         */
+        std::size_t spool_depth { 100000 };
+
+        /*!
+         * Number of reports waiting for their tracker ids to start
+         * spooling the following ones at, they are dropped without
+         * a spool.
+         */
+        std::size_t max_parked { 100000 };
+
+        /*!
+         * Commit time in milliseconds to start spooling at,
+         * 0 disables the check.
+         */
+        int spool_latency { 0 };
+
+        /*!
+         * Number of parsed reports a worker collects before handing them
+         * to the saver.
+         */
+        std::size_t push_batch { 64 };
+
+        /*!
+         * Maximum delay in milliseconds between database reconnection
+         * attempts.
+         */
+        int reconnect_backoff { 30000 };
+
+        /*!
+         * Number of recently saved reports remembered per tracker to drop
+         * retransmitted ones, 0 disables the check.
+         */
+        std::size_t dedup_window { 8 };
+
+        /*!
+         * Table of trackers latest states, empty disables the states
+         * and keep-alive reports are dropped by workers.
+         */
+        std::string state_table;
+
+        /*!
+         * Interval in seconds between tracker states flushes.
+         */
+        int state_interval { 5 };
+
+        /*!
+         * Stream reports into a staging table with a binary COPY instead
+         * of calling `loginsert` for each of them.
+         */
+        bool copy { false };
+
+        /*!
+         * Statement merging the staging table into the log in the COPY
+         * ingest mode.
+         */
+        std::string copy_merge
+        {
+            "select trackers.loginsert(id, datetime, lon, lat, speed, "
+            "odometer, course, sats_glonass, sats_gps) "
+            "from ys_td_staging order by n"
+        };
+
+        /*!
+         * Age in seconds of reports taken as buffered backlog, they go
+         * to the bulk lane behind live reports.
+         */
+        int live_age { 300 };
+
+        /*!
+         * Maximum number of bulk lane reports written in one transaction.
+         */
+        std::size_t bulk_batch_size { 5000 };
+
+        /*!
+         * Drive all shard connections with libpq non-blocking API from
+         * a single event loop thread instead of a thread per shard.
+         */
+        bool async { false };
+
+        /*!
+         * Bound in milliseconds of the time a live batch waits to fill up,
+         * so that replies held until a commit are not delayed much,
+         * 0 disables the bound.
+         */
+        int ack_latency { 20 };
+
+        /*!
+         * Interval in milliseconds of publishing tracker ids to workers.
+         */
+        int registry_interval { 1000 };
     };
 
     /*!
@@ -70,10 +260,32 @@ public:
          */
         std::vector<std::string> db;
 
+        /*!
+         * Database shards, in the order of connection strings.
+         */
+        std::vector<db_shard> shards;
+
+        /*!
+         * Connection strings of databases to look tracker ids up in,
+         * for example read replicas, the first shard is used when empty.
+         */
+        std::vector<std::string> lookup_db;
+
+        /*!
+         * Path of a config file with a new shards list to compare
+         * trackers placement with, the daemon isn't started if set.
+         */
+        std::string shard_dry_run;
+
         /*!
          * Ports settings.
          */
         std::map<int, port> ports;
+
+        /*!
+         * Saver settings.
+         */
+        saver_options saver;
     } data;
 
     /*!
@@ -107,6 +319,16 @@ public:
     void
     load_cfg_options();
 
+    /*!
+     * Load database shards from a config tree.
+     * \param tree Config tree with a `db` list.
+     * \param shards Output container.
+     */
+    static
+    void
+    load_shards(boost::property_tree::ptree const& tree,
+                std::vector<db_shard>& shards);
+
 private:
     /*!
      * Load ports configuration into variables.
@@ -114,6 +336,12 @@ private:
     void
     load_ports_cfg();
 
+    /*!
+     * Load saver configuration into variables.
+     */
+    void
+    load_saver_cfg();
+
     /*!
      * Print out config parameters.
      */
@@ -125,18 +353,61 @@ private:
            "cfg_path: " << c.data.cfg_path << std::endl <<
            "workers: " << c.data.w_count << std::endl;
 
-        for (std::string const& s: c.data.db)
+        for (auto& s: c.data.shards)
         {
-            os << "db[]: " << s << std::endl;
+            os << "db[]: " << s.name << ", weight " << s.weight << std::endl;
+        }
+
+        for (std::string const& s: c.data.lookup_db)
+        {
+            os << "lookup_db[]: " << s << std::endl;
         }
 
         for (auto& p: c.data.ports)
         {
             os << "ports[]: port " << p.second.num <<
-               ", parser " << p.second.parser
+               ", parser " << p.second.parser <<
+               ", ack_commit " << p.second.ack_commit
                << std::endl;
         }
 
+        os <<
+           "saver.queue_size: " << c.data.saver.queue_size << std::endl <<
+           "saver.writer_queue_size: " << c.data.saver.writer_queue_size <<
+           std::endl <<
+           "saver.batch_size: " << c.data.saver.batch_size << std::endl <<
+           "saver.batch_wait: " << c.data.saver.batch_wait << std::endl <<
+           "saver.stats_interval: " << c.data.saver.stats_interval <<
+           std::endl <<
+           "saver.id_snapshot: " << c.data.saver.id_snapshot << std::endl <<
+           "saver.id_snapshot_interval: " <<
+           c.data.saver.id_snapshot_interval << std::endl <<
+           "saver.unknown_ttl: " << c.data.saver.unknown_ttl << std::endl <<
+           "saver.insert_chunk: " << c.data.saver.insert_chunk << std::endl <<
+           "saver.spool: " << c.data.saver.spool << std::endl <<
+           "saver.spool_segment_size: " <<
+           c.data.saver.spool_segment_size << std::endl <<
+           "saver.spool_depth: " << c.data.saver.spool_depth << std::endl <<
+           "saver.max_parked: " << c.data.saver.max_parked << std::endl <<
+           "saver.spool_latency: " << c.data.saver.spool_latency <<
+           std::endl <<
+           "saver.push_batch: " << c.data.saver.push_batch << std::endl <<
+           "saver.reconnect_backoff: " << c.data.saver.reconnect_backoff <<
+           std::endl <<
+           "saver.dedup_window: " << c.data.saver.dedup_window << std::endl <<
+           "saver.state_table: " << c.data.saver.state_table << std::endl <<
+           "saver.state_interval: " << c.data.saver.state_interval <<
+           std::endl <<
+           "saver.copy: " << c.data.saver.copy << std::endl <<
+           "saver.copy_merge: " << c.data.saver.copy_merge << std::endl <<
+           "saver.live_age: " << c.data.saver.live_age << std::endl <<
+           "saver.bulk_batch_size: " << c.data.saver.bulk_batch_size <<
+           std::endl <<
+           "saver.async: " << c.data.saver.async << std::endl <<
+           "saver.ack_latency: " << c.data.saver.ack_latency << std::endl <<
+           "saver.registry_interval: " << c.data.saver.registry_interval <<
+           std::endl;
+
         return os;
     }
 };
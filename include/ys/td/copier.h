@@ -0,0 +1,127 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Binary COPY reports writer class header file.
+ */
+
+#ifndef YS_TD_COPIER_H
+#define YS_TD_COPIER_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <libpq-fe.h>
+#include <ys/td/report.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A class streaming reports into a staging table with a binary COPY
+ * and merging them into the log with a single statement.
+ *
+ * The staging table is a temporary table of the copier's own libpq
+ * connection, so every shard connection has its own one.
+ */
+class copier
+{
+public:
+    /*!
+     * A typedef for a report with resolved tracker id.
+     */
+    using row_type = std::pair<uint32_t, report>;
+
+    /*!
+     * Name of the staging table.
+     */
+    static const char* const staging_table;
+
+    /*!
+     * Constructor, the connection is opened on the first use.
+     * \param conn_str Connection string.
+     * \param merge Statement merging the staging table into the log.
+     */
+    copier(std::string const& conn_str, std::string const& merge);
+
+    /*!
+     * Destructor.
+     */
+    ~copier();
+
+    /*!
+     * Save reports in a single transaction.
+     * \param first
+     * \param last
+     * \throw pqxx::broken_connection
+     * \throw error
+     */
+    void
+    save(row_type const* first, row_type const* last);
+
+    /*!
+     * Encode reports as COPY binary format data.
+     * \param first
+     * \param last
+     * \param buf Output buffer.
+     */
+    static
+    void
+    encode(row_type const* first, row_type const* last, std::string& buf);
+
+private:
+    /*!
+     * Connection string.
+     */
+    std::string conn_str_;
+
+    /*!
+     * Merge statement.
+     */
+    std::string merge_;
+
+    /*!
+     * Connection.
+     */
+    PGconn* conn_ { nullptr };
+
+    /*!
+     * COPY data buffer.
+     */
+    std::string buf_;
+
+    /*!
+     * Open the connection and create the staging table if required.
+     * \throw pqxx::broken_connection
+     * \throw error
+     */
+    void
+    open();
+
+    /*!
+     * Execute a statement.
+     * \param sql
+     * \return Result status.
+     * \throw pqxx::broken_connection
+     * \throw error
+     */
+    ExecStatusType
+    exec(char const* sql);
+
+    /*!
+     * Throw an exception describing the last connection error.
+     * \throw pqxx::broken_connection
+     * \throw error
+     */
+    [[noreturn]]
+    void
+    fail();
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_COPIER_H
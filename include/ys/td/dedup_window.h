@@ -0,0 +1,135 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Duplicate reports filter header file.
+ */
+
+#ifndef YS_TD_DEDUP_WINDOW_H
+#define YS_TD_DEDUP_WINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <ys/td/report.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A filter of reports retransmitted by trackers.
+ *
+ * The filter remembers the time and the position of the last few saved
+ * reports of every tracker, a report matching one of them exactly is
+ * a duplicate. A report is remembered only once it is committed, so
+ * a retransmit of a report which failed to be saved or is still on its
+ * way to a database is not taken as a duplicate. Trackers are spread
+ * over stripes with their own locks, so that the workers checking
+ * reports and the writers adding them seldom wait for each other.
+ */
+class dedup_window
+{
+public:
+    /*!
+     * Constructor.
+     * \param size Number of reports remembered per tracker, 0 disables
+     *             the filter.
+     */
+    dedup_window(std::size_t size);
+
+    /*!
+     * Check whether the report was saved recently.
+     * \param id Tracker id.
+     * \param d
+     * \return True if the report is a duplicate.
+     */
+    bool
+    seen(uint32_t id, report const& d);
+
+    /*!
+     * Remember a saved report, replacing the oldest one of the tracker.
+     * \param id Tracker id.
+     * \param d
+     */
+    void
+    add(uint32_t id, report const& d);
+
+    /*!
+     * Get a number of trackers remembered.
+     * \return
+     */
+    std::size_t
+    trackers() const;
+
+private:
+    /*!
+     * Number of stripes.
+     */
+    static const std::size_t stripes = 64;
+
+    /*!
+     * Report fingerprint.
+     */
+    struct fingerprint
+    {
+        /*!
+         * Signal date/time.
+         */
+        int64_t datetime;
+
+        /*!
+         * Longitude.
+         */
+        int32_t lon;
+
+        /*!
+         * Latitude.
+         */
+        int32_t lat;
+    };
+
+    /*!
+     * Windows of a share of trackers.
+     */
+    struct stripe
+    {
+        /*!
+         * Offsets of trackers windows in `prints`, by tracker ids.
+         */
+        std::unordered_map<uint32_t, std::size_t> index;
+
+        /*!
+         * Trackers windows, `size_` fingerprints each, used as rings.
+         */
+        std::vector<fingerprint> prints;
+
+        /*!
+         * Positions of the next fingerprint to replace, one per window.
+         */
+        std::vector<uint32_t> next;
+
+        /*!
+         * Access mutex.
+         */
+        mutable std::mutex mutex;
+    };
+
+    /*!
+     * Number of reports remembered per tracker.
+     */
+    std::size_t size_;
+
+    /*!
+     * Stripes, by tracker ids.
+     */
+    stripe stripes_[stripes];
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_DEDUP_WINDOW_H
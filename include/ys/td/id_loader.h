@@ -0,0 +1,158 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids bulk loader class header file.
+ */
+
+#ifndef YS_TD_ID_LOADER_H
+#define YS_TD_ID_LOADER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <pqxx/pqxx>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A class loading all tracker ids with one query and keeping
+ * a local snapshot file of them.
+ *
+ * When run in a thread it periodically reloads the ids, rewrites
+ * the snapshot and hands fresh ids over through `take`.
+ */
+class id_loader
+{
+public:
+    /*!
+     * Tracker id entry.
+     */
+    struct entry
+    {
+        /*!
+         * Tracker id.
+         */
+        uint32_t id;
+
+        /*!
+         * The number is a sim number.
+         */
+        bool sim;
+
+        /*!
+         * Tracker type name.
+         */
+        std::string type;
+
+        /*!
+         * Tracker number or sim number.
+         */
+        std::string number;
+    };
+
+    /*!
+     * A typedef for loaded tracker ids, ordered by id.
+     */
+    using cache_type = std::vector<entry>;
+
+    /*!
+     * Constructor.
+     * \param conn_str Connection string of a database to load ids from.
+     * \param path Snapshot file path.
+     * \param interval Interval in seconds between reloads.
+     */
+    id_loader(std::string const& conn_str, std::string const& path,
+              int interval);
+
+    /*!
+     * Load all tracker ids with one query.
+     * \param conn Database connection.
+     * \param cache Output container.
+     */
+    static
+    void
+    load(pqxx::connection_base& conn, cache_type& cache);
+
+    /*!
+     * Read tracker ids from the snapshot file.
+     * \param cache Output container.
+     * \return False if there is no readable snapshot.
+     */
+    bool
+    read(cache_type& cache) const;
+
+    /*!
+     * Write tracker ids to the snapshot file.
+     * \param cache
+     */
+    void
+    write(cache_type const& cache) const;
+
+    /*!
+     * Start the periodic reload process.
+     */
+    void
+    run();
+
+    /*!
+     * Interrupt execution.
+     */
+    void
+    interrupt();
+
+    /*!
+     * Take freshly reloaded ids if there are any.
+     * \param cache Container to swap fresh ids into.
+     * \return True if fresh ids were taken.
+     */
+    bool
+    take(cache_type& cache);
+
+private:
+    /*!
+     * Connection string.
+     */
+    std::string conn_str_;
+
+    /*!
+     * Snapshot file path.
+     */
+    std::string path_;
+
+    /*!
+     * Reload interval in seconds.
+     */
+    int interval_;
+
+    /*!
+     * Freshly reloaded ids not taken yet.
+     */
+    std::unique_ptr<cache_type> fresh_;
+
+    /*!
+     * Access mutex.
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Interruption condition.
+     */
+    std::condition_variable cond_;
+
+    /*!
+     * Interruption flag.
+     */
+    bool interrupted_ { false };
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_ID_LOADER_H
@@ -0,0 +1,259 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids hash table header file.
+ */
+
+#ifndef YS_TD_ID_TABLE_H
+#define YS_TD_ID_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Open addressing hash table of tracker ids.
+ *
+ * Trackers are keyed by their number (or sim number) stored inline and
+ * an interned type id, so lookups do no heap allocation and touch a single
+ * cache line in the common case.
+ */
+class id_table
+{
+public:
+    /*!
+     * Maximum length of a tracker number kept in the table.
+     */
+    static const std::size_t max_number = 32;
+
+    /*!
+     * Lookup key, refers to the number owned by the caller.
+     */
+    struct key_type
+    {
+        /*!
+         * Tracker number or sim number.
+         */
+        char const* number;
+
+        /*!
+         * Number length.
+         */
+        std::size_t size;
+
+        /*!
+         * Interned tracker type id.
+         */
+        uint16_t type;
+
+        /*!
+         * The number is a sim number.
+         */
+        bool sim;
+    };
+
+    /*!
+     * Table value.
+     */
+    struct value_type
+    {
+        /*!
+         * Tracker id, 0 for trackers missing in a database.
+         */
+        uint32_t id;
+
+        /*!
+         * Expiration time of a missing tracker entry.
+         */
+        int64_t expires;
+    };
+
+    /*!
+     * Constructor.
+     * \param capacity Expected number of entries.
+     */
+    id_table(std::size_t capacity = 0);
+
+    /*!
+     * Check whether the key can be kept in the table.
+     * \param k
+     * \return
+     */
+    static
+    bool
+    fits(key_type const& k);
+
+    /*!
+     * Find a value by key.
+     * \param k
+     * \return Null if there is no such key.
+     */
+    value_type*
+    find(key_type const& k);
+
+    /*!
+     * Find a value by key.
+     * \param k
+     * \return Null if there is no such key.
+     */
+    value_type const*
+    find(key_type const& k) const;
+
+    /*!
+     * Find a value by key, add a zeroed one if there is no such key.
+     * \param k
+     * \return Null if the key does not fit the table.
+     */
+    value_type*
+    insert(key_type const& k);
+
+    /*!
+     * Remove all entries matching the predicate.
+     * \param pred Predicate taking `value_type const&`.
+     */
+    template<typename Pred>
+    void
+    erase_if(Pred pred)
+    {
+        std::vector<slot> slots;
+
+        slots.swap(slots_);
+        slots_.resize(slots.size());
+        size_ = 0;
+
+        for (auto& s: slots)
+        {
+            if (s.hash && !pred(s.value))
+                place(s);
+        }
+    }
+
+    /*!
+     * Call a function for every entry.
+     * \param fn Function taking `key_type const&, value_type const&`.
+     */
+    template<typename Fn>
+    void
+    for_each(Fn fn) const
+    {
+        for (auto& s: slots_)
+        {
+            if (s.hash)
+                fn(key_type { s.number, s.size, s.type, s.sim != 0 }, s.value);
+        }
+    }
+
+    /*!
+     * Get a number of entries.
+     * \return
+     */
+    std::size_t
+    size() const;
+
+    /*!
+     * Swap contents with another table.
+     * \param t
+     */
+    void
+    swap(id_table& t);
+
+private:
+    /*!
+     * Table slot, empty when the hash is 0.
+     */
+    struct slot
+    {
+        /*!
+         * Key hash.
+         */
+        uint64_t hash;
+
+        /*!
+         * Tracker number.
+         */
+        char number[max_number];
+
+        /*!
+         * Interned tracker type id.
+         */
+        uint16_t type;
+
+        /*!
+         * Number length.
+         */
+        uint8_t size;
+
+        /*!
+         * The number is a sim number.
+         */
+        uint8_t sim;
+
+        /*!
+         * Slot value.
+         */
+        value_type value;
+    };
+
+    /*!
+     * Table slots, the size is a power of two.
+     */
+    std::vector<slot> slots_;
+
+    /*!
+     * Number of occupied slots.
+     */
+    std::size_t size_ { 0 };
+
+    /*!
+     * Compute a key hash, never 0.
+     * \param k
+     * \return
+     */
+    static
+    uint64_t
+    hash(key_type const& k);
+
+    /*!
+     * Check whether the slot holds the key.
+     * \param s
+     * \param h Key hash.
+     * \param k
+     * \return
+     */
+    static
+    bool
+    match(slot const& s, uint64_t h, key_type const& k);
+
+    /*!
+     * Find a slot holding the key or an empty slot to put it into.
+     * \param h Key hash.
+     * \param k
+     * \return
+     */
+    slot&
+    probe(uint64_t h, key_type const& k);
+
+    /*!
+     * Put an occupied slot into the table known not to contain its key.
+     * \param s
+     */
+    void
+    place(slot const& s);
+
+    /*!
+     * Double the number of slots.
+     */
+    void
+    grow();
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_ID_TABLE_H
@@ -0,0 +1,184 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Parser input buffer header file.
+ */
+
+#ifndef YS_TD_INPUT_BUFFER_H
+#define YS_TD_INPUT_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A contiguous buffer of not yet parsed bytes.
+ *
+ * Consuming bytes from the front only advances the read offset, the unread
+ * bytes are moved to the front when more data is appended and the consumed
+ * part is at least as large as the unread one. So every byte is moved
+ * a constant number of times on average, however many messages a burst
+ * holds. The buffer looks like a vector of the unread bytes.
+ *
+ * The buffer may also borrow bytes owned by someone else, so that complete
+ * messages are parsed where they were received. Only the bytes left when
+ * the borrowed ones are about to be reused are copied.
+ */
+class input_buffer
+{
+public:
+    /*!
+     * Storage typedef.
+     */
+    using storage_type = std::vector<uint8_t>;
+
+    /*!
+     * Byte typedef.
+     */
+    using value_type = storage_type::value_type;
+
+    /*!
+     * Iterator typedef, the bytes are read only.
+     */
+    using iterator = value_type const*;
+
+    /*!
+     * Constant iterator typedef.
+     */
+    using const_iterator = value_type const*;
+
+    /*!
+     * Append bytes to the buffer.
+     * \param first
+     * \param last
+     */
+    template<typename Iterator>
+    void
+    append(Iterator first, Iterator last)
+    {
+        detach();
+        compact(std::distance(first, last));
+        data_.insert(data_.end(), first, last);
+    }
+
+    /*!
+     * Add bytes to the buffer without copying them if it is empty.
+     *
+     * The bytes must stay intact until `detach` is called, the buffer
+     * must not be changed otherwise meanwhile except by consuming.
+     *
+     * \param p
+     * \param n
+     */
+    void
+    borrow(value_type const* p, std::size_t n);
+
+    /*!
+     * Copy borrowed bytes not consumed yet into the buffer.
+     */
+    void
+    detach();
+
+    /*!
+     * Drop `n` bytes from the front, all of them if there are fewer.
+     * \param n
+     */
+    void
+    consume(std::size_t n);
+
+    /*!
+     * Drop bytes in the range `[begin(), it)`.
+     * \param it
+     */
+    void
+    consume(const_iterator it);
+
+    /*!
+     * Drop all bytes.
+     */
+    void
+    clear();
+
+    /*!
+     * Get an iterator to the first unread byte.
+     * \return
+     */
+    const_iterator
+    begin() const;
+
+    /*!
+     * Get an iterator past the last byte.
+     * \return
+     */
+    const_iterator
+    end() const;
+
+    /*!
+     * Get a pointer to the first unread byte.
+     * \return
+     */
+    value_type const*
+    data() const;
+
+    /*!
+     * Get an unread byte.
+     * \param i Index from the first unread byte.
+     * \return
+     */
+    value_type
+    operator[](std::size_t i) const;
+
+    /*!
+     * Get a number of unread bytes.
+     * \return
+     */
+    std::size_t
+    size() const;
+
+    /*!
+     * Check whether there are no unread bytes.
+     * \return
+     */
+    bool
+    empty() const;
+
+private:
+    /*!
+     * Consumed and unread bytes.
+     */
+    storage_type data_;
+
+    /*!
+     * Offset of the first unread byte.
+     */
+    std::size_t offset_ { 0 };
+
+    /*!
+     * First unread borrowed byte, null when nothing is borrowed.
+     */
+    value_type const* borrowed_ { nullptr };
+
+    /*!
+     * Number of unread borrowed bytes.
+     */
+    std::size_t borrowed_size_ { 0 };
+
+    /*!
+     * Move unread bytes to the front if it is worth it before appending.
+     * \param n Number of bytes to append.
+     */
+    void
+    compact(std::size_t n);
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_INPUT_BUFFER_H
@@ -0,0 +1,270 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Blocking queue with live and bulk lanes.
+ */
+
+#ifndef YS_TD_LANE_QUEUE_H
+#define YS_TD_LANE_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Report lanes, live reports are fresh positions, bulk ones are reports
+ * buffered by trackers during a coverage gap.
+ */
+enum class lane
+{
+    live,
+    bulk
+};
+
+/*!
+ * A blocking queue which hands out its items in batches, items of the live
+ * lane are always handed out before the bulk ones.
+ */
+template<typename T>
+class lane_queue
+{
+public:
+    /*!
+     * Queue item typedef.
+     */
+    using value_type = T;
+
+    /*!
+     * Move a range of items to a lane of the queue under a single lock.
+     * \param l Lane.
+     * \param first
+     * \param last
+     */
+    template<typename Iterator>
+    void
+    push(lane l, Iterator first, Iterator last)
+    {
+        {
+            std::lock_guard<std::mutex> lock { mutex_ };
+            auto& items = items_[index(l)];
+            items.insert(items.end(), std::make_move_iterator(first),
+                         std::make_move_iterator(last));
+            size_[index(l)] = items.size();
+        }
+
+        cond_.notify_one();
+    }
+
+    /*!
+     * Wait for items and move a batch of one lane into `out`.
+     *
+     * The call blocks until at least one item is available. A live batch
+     * keeps collecting items until `max_live` of them are taken or `wait`
+     * has passed since the first one was taken. A bulk batch is taken
+     * only when the live lane is empty and is not waited for, so that live
+     * items arriving meanwhile are not held up.
+     *
+     * \param out Output vector, items are appended to it.
+     * \param max_live Maximum number of live items to take.
+     * \param max_bulk Maximum number of bulk items to take.
+     * \param wait Time to wait for a live batch to fill up.
+     * \param taken Output lane of the batch.
+     * \return False if the queue was interrupted and is empty.
+     */
+    bool
+    pop(std::vector<value_type>& out, std::size_t max_live,
+        std::size_t max_bulk, std::chrono::milliseconds wait, lane& taken)
+    {
+        std::unique_lock<std::mutex> lock { mutex_ };
+
+        cond_.wait(lock, [this]() { return ready(); });
+
+        if (!items_[index(lane::live)].empty())
+        {
+            taken = lane::live;
+            take(lock, out, taken, max_live, wait);
+            return true;
+        }
+
+        if (!items_[index(lane::bulk)].empty())
+        {
+            taken = lane::bulk;
+            take(lock, out, taken, max_bulk, std::chrono::milliseconds { 0 });
+            return true;
+        }
+
+        return false;
+    }
+
+    /*!
+     * Move a batch of one lane into `out` without waiting, live items
+     * first.
+     * \param out Output vector, items are appended to it.
+     * \param max_live Maximum number of live items to take.
+     * \param max_bulk Maximum number of bulk items to take.
+     * \param taken Output lane of the batch.
+     * \return False if the queue is empty.
+     */
+    bool
+    try_pop(std::vector<value_type>& out, std::size_t max_live,
+            std::size_t max_bulk, lane& taken)
+    {
+        std::unique_lock<std::mutex> lock { mutex_ };
+
+        for (lane l: { lane::live, lane::bulk })
+        {
+            if (!items_[index(l)].empty())
+            {
+                taken = l;
+                take(lock, out, l, l == lane::live ? max_live : max_bulk,
+                     std::chrono::milliseconds { 0 });
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /*!
+     * Interrupt waiting for items.
+     *
+     * Items still in the queue are handed out by subsequent `pop` calls,
+     * which return false once the queue is empty.
+     */
+    void
+    interrupt()
+    {
+        {
+            std::lock_guard<std::mutex> lock { mutex_ };
+            interrupted_ = true;
+        }
+
+        cond_.notify_all();
+    }
+
+    /*!
+     * Get a number of items in a lane without locking the queue.
+     * \param l Lane.
+     * \return
+     */
+    std::size_t
+    size(lane l) const
+    {
+        return size_[index(l)];
+    }
+
+    /*!
+     * Get a number of items in the queue without locking it.
+     * \return
+     */
+    std::size_t
+    size() const
+    {
+        return size(lane::live) + size(lane::bulk);
+    }
+
+private:
+    /*!
+     * Queue items by lanes.
+     */
+    std::deque<value_type> items_[2];
+
+    /*!
+     * Number of items of every lane readable without locking.
+     */
+    std::atomic<std::size_t> size_[2] { { 0 }, { 0 } };
+
+    /*!
+     * Items access mutex.
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Items arrival condition.
+     */
+    std::condition_variable cond_;
+
+    /*!
+     * Interruption flag.
+     */
+    bool interrupted_ { false };
+
+    /*!
+     * Get an index of a lane.
+     * \param l
+     * \return
+     */
+    static
+    std::size_t
+    index(lane l)
+    {
+        return static_cast<std::size_t>(l);
+    }
+
+    /*!
+     * Check whether there are items to take or the queue is interrupted.
+     * \return
+     */
+    bool
+    ready() const
+    {
+        return interrupted_ || !items_[0].empty() || !items_[1].empty();
+    }
+
+    /*!
+     * Move up to `max` items of a lane into `out` waiting for them
+     * no longer than `wait`.
+     * \param lock Lock of the items mutex.
+     * \param out Output vector, items are appended to it.
+     * \param l Lane.
+     * \param max Maximum number of items to take.
+     * \param wait Time to wait for the batch to fill up.
+     */
+    void
+    take(std::unique_lock<std::mutex>& lock, std::vector<value_type>& out,
+         lane l, std::size_t max, std::chrono::milliseconds wait)
+    {
+        std::size_t i = index(l);
+        auto& items = items_[i];
+        auto deadline = std::chrono::steady_clock::now() + wait;
+        std::size_t taken = 0;
+
+        for (;;)
+        {
+            while (taken < max && !items.empty())
+            {
+                out.push_back(std::move(items.front()));
+                items.pop_front();
+                ++taken;
+            }
+
+            size_[i] = items.size();
+
+            /*
+             * Stop when the batch is full, the queue is interrupted
+             * or no more items arrived in time.
+             */
+            if (taken == max || interrupted_ ||
+                !cond_.wait_until(lock, deadline, [this, &items]()
+                {
+                    return interrupted_ || !items.empty();
+                }))
+                break;
+        }
+    }
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_LANE_QUEUE_H
@@ -0,0 +1,343 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Bounded multi-producer single-consumer ring.
+ */
+
+#ifndef YS_TD_MPSC_RING_H
+#define YS_TD_MPSC_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A bounded lock-free ring of fixed-size slots for many producers and
+ * a single consumer.
+ *
+ * Producers claim slots with a single CAS and never block, the consumer
+ * drains published slots in batches and sleeps only when the ring
+ * is empty.
+ */
+template<typename T>
+class mpsc_ring
+{
+public:
+    /*!
+     * Ring item typedef.
+     */
+    using value_type = T;
+
+    /*!
+     * Constructor.
+     * \param capacity Number of slots, rounded up to a power of two.
+     */
+    mpsc_ring(std::size_t capacity)
+    {
+        std::size_t n = 2;
+
+        while (n < capacity)
+            n *= 2;
+
+        mask_ = n - 1;
+        slots_.reset(new slot[n]);
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * Add an item to the ring.
+     * \param v
+     * \return False if the ring is full.
+     */
+    bool
+    push(value_type const& v)
+    {
+        slot* s;
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            s = &slots_[pos & mask_];
+
+            std::size_t seq = s->seq.load(std::memory_order_acquire);
+            std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - pos);
+
+            if (dif == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed))
+                    break;
+            }
+            else if (dif < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        s->value = v;
+        s->seq.store(pos + 1, std::memory_order_release);
+
+        wake();
+
+        return true;
+    }
+
+    /*!
+     * Move a range of items to the ring claiming their slots at once.
+     *
+     * If the whole range does not fit, a smaller leading part of it
+     * is pushed.
+     *
+     * \param first
+     * \param last
+     * \return Number of pushed items.
+     */
+    template<typename Iterator>
+    std::size_t
+    push(Iterator first, Iterator last)
+    {
+        std::size_t n = std::distance(first, last);
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+
+        if (n > mask_ + 1)
+            n = mask_ + 1;
+
+        while (n > 0)
+        {
+            /*
+             * The consumer frees slots in order, so the range is free when
+             * its last slot is.
+             */
+
+            std::size_t end = pos + n - 1;
+            slot& s = slots_[end & mask_];
+
+            std::size_t seq = s.seq.load(std::memory_order_acquire);
+            std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - end);
+
+            if (dif == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + n,
+                                                std::memory_order_relaxed))
+                    break;
+            }
+            else if (dif < 0)
+            {
+                n /= 2;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i, ++first)
+        {
+            slot& s = slots_[(pos + i) & mask_];
+
+            s.value = std::move(*first);
+            s.seq.store(pos + i + 1, std::memory_order_release);
+        }
+
+        if (n)
+            wake();
+
+        return n;
+    }
+
+    /*!
+     * Move up to `max` items into `out`, waiting for the first one no longer
+     * than `timeout`.
+     * \param out Output vector, items are appended to it.
+     * \param max Maximum number of items to take.
+     * \param timeout Time to wait for the first item.
+     * \return False if the ring was interrupted and is empty.
+     */
+    bool
+    pop(std::vector<value_type>& out, std::size_t max,
+        std::chrono::milliseconds timeout)
+    {
+        if (!ready())
+        {
+            std::unique_lock<std::mutex> lock { mutex_ };
+
+            /*
+             * Producers look at the flag after publishing an item, so
+             * either the item is seen here or a wake-up follows.
+             */
+            sleeping_.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            cond_.wait_for(lock, timeout, [this]()
+            {
+                return ready() || interrupted_.load();
+            });
+
+            sleeping_.store(false);
+        }
+
+        std::size_t taken = 0;
+
+        while (taken < max && ready())
+        {
+            slot& s = slots_[head_ & mask_];
+
+            out.push_back(std::move(s.value));
+            s.seq.store(head_ + mask_ + 1, std::memory_order_release);
+
+            ++head_;
+            ++taken;
+        }
+
+        head_pos_.store(head_, std::memory_order_relaxed);
+
+        return taken || !interrupted_.load();
+    }
+
+    /*!
+     * Interrupt waiting for items.
+     *
+     * Items still in the ring are handed out by subsequent `pop` calls,
+     * which return false once the ring is empty.
+     */
+    void
+    interrupt()
+    {
+        {
+            std::lock_guard<std::mutex> lock { mutex_ };
+            interrupted_ = true;
+        }
+
+        cond_.notify_all();
+    }
+
+    /*!
+     * Get an approximate number of items in the ring.
+     * \return
+     */
+    std::size_t
+    size() const
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_pos_.load(std::memory_order_relaxed);
+
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    /*!
+     * Ring slot.
+     */
+    struct slot
+    {
+        /*!
+         * Slot sequence number, equals to the position for a free slot
+         * and to the position + 1 for a published one.
+         */
+        std::atomic<std::size_t> seq;
+
+        /*!
+         * Slot value.
+         */
+        value_type value;
+    };
+
+    /*!
+     * Ring slots.
+     */
+    std::unique_ptr<slot[]> slots_;
+
+    /*!
+     * Slot index mask.
+     */
+    std::size_t mask_;
+
+    /*!
+     * Position of the next slot to claim by producers.
+     */
+    alignas(64) std::atomic<std::size_t> tail_ { 0 };
+
+    /*!
+     * Position of the next slot to read, owned by the consumer.
+     */
+    alignas(64) std::size_t head_ { 0 };
+
+    /*!
+     * Consumer position published for `size`.
+     */
+    std::atomic<std::size_t> head_pos_ { 0 };
+
+    /*!
+     * The consumer is going to sleep or sleeps.
+     */
+    alignas(64) std::atomic<bool> sleeping_ { false };
+
+    /*!
+     * Interruption flag.
+     */
+    std::atomic<bool> interrupted_ { false };
+
+    /*!
+     * Consumer sleep mutex.
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Items arrival condition.
+     */
+    std::condition_variable cond_;
+
+    /*!
+     * Check whether the next slot to read is published.
+     * \return
+     */
+    bool
+    ready() const
+    {
+        return slots_[head_ & mask_].seq.load(std::memory_order_acquire) ==
+               head_ + 1;
+    }
+
+    /*!
+     * Wake the consumer up if it sleeps.
+     */
+    void
+    wake()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (sleeping_.load(std::memory_order_relaxed))
+        {
+            {
+                std::lock_guard<std::mutex> lock { mutex_ };
+            }
+
+            cond_.notify_one();
+        }
+    }
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_MPSC_RING_H
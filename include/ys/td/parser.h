@@ -13,7 +13,10 @@
 #include <cstdint>
 #include <algorithm>
 #include <iterator>
+#include <ostream>
 #include <type_traits>
+#include <ys/td/input_buffer.h>
+#include <ys/td/report.h>
 
 namespace ys
 {
@@ -31,6 +34,11 @@ public:
      */
     using buffer_type = std::vector<uint8_t>;
 
+    /*!
+     * Input buffer typedef.
+     */
+    using input_type = input_buffer;
+
     /*!
      * Parsing result structure.
      */
@@ -55,88 +63,7 @@ public:
     /*!
      * Parsed data.
      */
-    struct data_type
-    {
-        /*!
-         * Tracker phone number.
-         */
-        std::string phone;
-
-        /*!
-         * Tracker number.
-         */
-        std::string num;
-
-        /*!
-         * Tracker type name.
-         */
-        std::string type;
-
-        /*!
-         * Signal date/time.
-         */
-        std::string datetime;
-
-        /*!
-         * Longitude.
-         */
-        double lon {};
-
-        /*!
-         * Latitude.
-         */
-        double lat {};
-
-        /*!
-         * Speed.
-         */
-        double speed {};
-
-        /*!
-         * Odometer.
-         */
-        uint32_t odometer {};
-
-        /*!
-         * Course.
-         */
-        double course {};
-
-        /*!
-         * Number of GLONASS satellites.
-         */
-        uint32_t sats_glonass {};
-
-        /*!
-         * Number of GPS satellites.
-         */
-        uint32_t sats_gps {};
-
-        /*!
-         * Parsed data output.
-         * \param os
-         * \param d
-         * \return
-         */
-        friend
-        std::ostream& operator<<(std::ostream& os, data_type const& d)
-        {
-            os <<
-                "num " << d.num << ", " <<
-                "type " << d.type << ", " <<
-                "datetime " << d.datetime << ", " <<
-                "lon " << d.lon << ", " <<
-                "lat " << d.lat << ", " <<
-                "speed " << d.speed << ", " <<
-                "odometer " << d.odometer << ", " <<
-                "course " << d.course << ", " <<
-                "sats_glonass " << d.sats_glonass << ", " <<
-                "sats_gps " << d.sats_gps <<
-                std::endl;
-
-            return os;
-        }
-    };
+    using data_type = report;
 
     /*!
      * Construct parser object.
@@ -151,6 +78,10 @@ public:
 
     /*!
      * Load data from the external buffer to the parser buffer.
+     *
+     * Complete messages are parsed right in the external buffer, it must
+     * stay intact until `detach` is called.
+     *
      * \param b External buffer.
      * \param n Number of bytes to load.
      */
@@ -158,11 +89,16 @@ public:
     void
     load(Buffer const& b, std::size_t n)
     {
-        auto ii = b.begin();
-        buffer_.reserve(buffer_.size() + n);
-        std::copy(ii, std::next(ii, n), std::back_inserter(buffer_));
+        buffer_.borrow(reinterpret_cast<uint8_t const*>(b.data()), n);
     }
 
+    /*!
+     * Copy loaded data not parsed yet from the external buffer before
+     * it is reused.
+     */
+    void
+    detach();
+
     /*!
      * Get parsed data.
      * \return
@@ -180,7 +116,7 @@ public:
      * Get a reference to a parser buffer.
      * \return
      */
-    buffer_type const&
+    input_type const&
     buffer() const;
 
     /*!
@@ -208,7 +144,7 @@ protected:
     /*!
      * Buffer with not yet parsed data.
      */
-    buffer_type buffer_;
+    input_type buffer_;
 
     /*!
      * Vector with response bytes.
@@ -227,7 +163,7 @@ protected:
      * \param it
      */
     void
-    consume(buffer_type::iterator it);
+    consume(input_type::const_iterator it);
 
     /*!
      * Erase all bytes in the buffer.
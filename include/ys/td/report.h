@@ -0,0 +1,211 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Compact tracker report header file.
+ */
+
+#ifndef YS_TD_REPORT_H
+#define YS_TD_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Tracker report passed from parsers to a database.
+ *
+ * The report is a fixed-size POD: the tracker number is kept inline,
+ * the type name is interned, the time is an epoch and the numbers are
+ * packed, so queuing, moving and spooling a report never touches a heap.
+ */
+struct report
+{
+    /*!
+     * Maximum length of a tracker number.
+     */
+    static const std::size_t max_number = 32;
+
+    /*!
+     * Signal date/time, seconds since the epoch (UTC).
+     */
+    int64_t datetime {};
+
+    /*!
+     * Longitude, millionths of a degree.
+     */
+    int32_t lon {};
+
+    /*!
+     * Latitude, millionths of a degree.
+     */
+    int32_t lat {};
+
+    /*!
+     * Odometer.
+     */
+    uint32_t odometer {};
+
+    /*!
+     * Speed.
+     */
+    uint16_t speed {};
+
+    /*!
+     * Course.
+     */
+    uint16_t course {};
+
+    /*!
+     * Interned tracker type id, see `type_registry`.
+     */
+    uint16_t type {};
+
+    /*!
+     * Number of GLONASS satellites.
+     */
+    uint8_t sats_glonass {};
+
+    /*!
+     * Number of GPS satellites.
+     */
+    uint8_t sats_gps {};
+
+    /*!
+     * Tracker number length.
+     */
+    uint8_t number_size {};
+
+    /*!
+     * The number is a tracker sim (phone) number.
+     */
+    bool sim {};
+
+    /*!
+     * A keep-alive report, it has no position and its time is the time
+     * of arrival.
+     */
+    bool alive {};
+
+    /*!
+     * Tracker number or sim number, not null-terminated.
+     */
+    char number[max_number] {};
+
+    /*!
+     * Delivery ticket of a worker waiting for the report to be committed,
+     * 0 if nobody waits, see `ack_table`.
+     */
+    uint32_t ack {};
+
+    /*!
+     * Set the tracker number.
+     * \param s Tracker number or sim number.
+     * \param is_sim The number is a sim number.
+     * \return False if the number does not fit, the report is left
+     *         unchanged.
+     */
+    bool
+    set_number(std::string const& s, bool is_sim = false)
+    {
+        return set_number(s.data(), s.size(), is_sim);
+    }
+
+    /*!
+     * Set the tracker number.
+     * \param s Tracker number or sim number, not null-terminated.
+     * \param n Number length.
+     * \param is_sim The number is a sim number.
+     * \return False if the number does not fit, the report is left
+     *         unchanged. A truncated number would be taken for another
+     *         tracker.
+     */
+    bool
+    set_number(char const* s, std::size_t n, bool is_sim = false)
+    {
+        if (n > max_number)
+            return false;
+
+        number_size = n;
+        std::memcpy(number, s, n);
+        sim = is_sim;
+
+        return true;
+    }
+
+    /*!
+     * Get the tracker number.
+     * \return
+     */
+    std::string
+    get_number() const
+    {
+        return { number, number_size };
+    }
+
+    /*!
+     * Report output.
+     * \param os
+     * \param d
+     * \return
+     */
+    friend
+    std::ostream& operator<<(std::ostream& os, report const& d)
+    {
+        os <<
+            (d.alive ? "alive, " : "") <<
+            (d.sim ? "sim " : "num ") << d.get_number() << ", " <<
+            "type " << d.type << ", " <<
+            "datetime " << d.datetime << ", " <<
+            "lon " << d.lon << ", " <<
+            "lat " << d.lat << ", " <<
+            "speed " << d.speed << ", " <<
+            "odometer " << d.odometer << ", " <<
+            "course " << d.course << ", " <<
+            "sats_glonass " << +d.sats_glonass << ", " <<
+            "sats_gps " << +d.sats_gps <<
+            std::endl;
+
+        return os;
+    }
+};
+
+/*!
+ * Registry of interned tracker type names shared by all threads.
+ *
+ * Type ids are assigned on first use and never change while the process
+ * runs, id 0 is an empty name.
+ */
+class type_registry
+{
+public:
+    /*!
+     * Get an id of the type name, registering it if required.
+     * \param name
+     * \return
+     */
+    static
+    uint16_t
+    intern(std::string const& name);
+
+    /*!
+     * Get a type name by its id.
+     * \param id
+     * \return Empty string for an unknown id.
+     */
+    static
+    std::string
+    name(uint16_t id);
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_REPORT_H
@@ -0,0 +1,169 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids batch resolver class header file.
+ */
+
+#ifndef YS_TD_RESOLVER_H
+#define YS_TD_RESOLVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ys/db/pool.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A class resolving tracker ids missing in the cache in batches.
+ *
+ * Requests are collected while a previous batch is being resolved and
+ * are resolved together, with one query per tracker type and number kind,
+ * on the resolver's own connections. Every connection has a thread taking
+ * up batches, so the load is spread over the lookup databases and a broken
+ * one leaves its share to the others. A failed batch is retried, a lookup
+ * never takes a tracker as unknown unless a database says so.
+ */
+class resolver
+{
+public:
+    /*!
+     * Tracker id request and its result.
+     */
+    struct request
+    {
+        /*!
+         * Tracker number or sim number.
+         */
+        std::string number;
+
+        /*!
+         * Interned tracker type id.
+         */
+        uint16_t type;
+
+        /*!
+         * The number is a sim number.
+         */
+        bool sim;
+
+        /*!
+         * Resolved tracker id, 0 if there is no such tracker.
+         */
+        uint32_t id;
+    };
+
+    /*!
+     * Constructor.
+     * \param conn_str Connection strings of databases to look ids up in.
+     * \param max_backoff Maximum delay between reconnection attempts.
+     */
+    resolver(std::vector<std::string> const& conn_str,
+             std::chrono::milliseconds max_backoff);
+
+    /*!
+     * Start the resolving process, one thread per lookup connection.
+     */
+    void
+    run();
+
+    /*!
+     * Interrupt execution.
+     */
+    void
+    interrupt();
+
+    /*!
+     * Add a request to the next batch.
+     * \param r
+     */
+    void
+    push(request const& r);
+
+    /*!
+     * Take resolved requests if there are any.
+     * \param out Output vector, requests are appended to it.
+     * \return True if any requests were taken.
+     */
+    bool
+    take(std::vector<request>& out);
+
+    /*!
+     * Get a number of executed queries.
+     * \return
+     */
+    uint64_t
+    queries() const;
+
+    /*!
+     * Get lookup connections.
+     * \return
+     */
+    ys::db::pool const&
+    db() const;
+
+private:
+    /*!
+     * Lookup connections.
+     */
+    ys::db::pool db_;
+
+    /*!
+     * Requests waiting for the next batch.
+     */
+    std::vector<request> requests_;
+
+    /*!
+     * Resolved requests not taken yet.
+     */
+    std::vector<request> resolved_;
+
+    /*!
+     * Number of executed queries.
+     */
+    std::atomic<uint64_t> queries_ { 0 };
+
+    /*!
+     * Access mutex.
+     */
+    std::mutex mutex_;
+
+    /*!
+     * Requests arrival condition, shared by all connections.
+     */
+    std::condition_variable cond_;
+
+    /*!
+     * Interruption flag.
+     */
+    bool interrupted_ { false };
+
+    /*!
+     * Resolve batches on a lookup connection.
+     * \param i Connection index.
+     */
+    void
+    work(std::size_t i);
+
+    /*!
+     * Resolve a batch of requests.
+     * \param i Connection index.
+     * \param batch
+     * \return False if the batch failed and is to be retried.
+     */
+    bool
+    resolve(std::size_t i, std::vector<request>& batch);
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_RESOLVER_H
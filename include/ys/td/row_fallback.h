@@ -0,0 +1,64 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Row by row saving of a failed batch header file.
+ */
+
+#ifndef YS_TD_ROW_FALLBACK_H
+#define YS_TD_ROW_FALLBACK_H
+
+#include <cstddef>
+#include <exception>
+#include <vector>
+#include <pqxx/pqxx>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Save rows of a failed batch one by one, so that a single bad row does
+ * not take the whole batch down with it.
+ *
+ * A row failed with an error other than a broken connection is handed
+ * to `fail` and the rest are tried. When the connection breaks the rows
+ * tried already, saved or failed, are handed to `release` and removed
+ * from the batch, which keeps only the rows to be sent again once the
+ * connection is reopened.
+ * \param batch Rows.
+ * \param save Function saving a row, it throws on failure.
+ * \param fail Function taking a failed row and its error.
+ * \param release Function taking a range of rows tried before
+ *                the connection broke.
+ * \throw pqxx::broken_connection
+ */
+template<typename Row, typename Save, typename Fail, typename Release>
+void
+save_row_by_row(std::vector<Row>& batch, Save save, Fail fail,
+                Release release)
+{
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        try
+        {
+            save(batch[i]);
+        }
+        catch (pqxx::broken_connection const&)
+        {
+            release(batch.cbegin(), batch.cbegin() + i);
+            batch.erase(batch.begin(), batch.begin() + i);
+            throw;
+        }
+        catch (std::exception const& e)
+        {
+            fail(batch[i], e);
+        }
+    }
+}
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_ROW_FALLBACK_H
@@ -1,18 +1,35 @@
 /*!
- * \file   
+ * \file
  * \author Stanislav Yaranov <stanislav.yaranov@gmail.com>
  * \date   2016-08-29
- * \brief  
+ * \brief
  */
 
 #ifndef YS_TD_SAVER_H
 #define YS_TD_SAVER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
 #include <vector>
 #include <string>
-#include <map>
-#include <ys/td/parser.h>
-#include <ys/blocking_queue.h>
+#include <unordered_map>
+#include <ys/td/ack_table.h>
+#include <ys/td/config.h>
+#include <ys/td/dedup_window.h>
+#include <ys/td/id_loader.h>
+#include <ys/td/id_table.h>
+#include <ys/td/lane_queue.h>
+#include <ys/td/mpsc_ring.h>
+#include <ys/td/report.h>
+#include <ys/td/resolver.h>
+#include <ys/td/tracker_registry.h>
+#include <ys/td/shard_ring.h>
+#include <ys/td/spool.h>
+#include <ys/td/state_table.h>
+#include <ys/td/writer.h>
 #include <ys/db/pool.h>
 
 namespace ys
@@ -22,15 +39,111 @@ namespace td
 
 /*!
  * A class for updating parsed data in a database.
+ *
+ * The saver resolves tracker ids and routes reports to shard writers,
+ * each of them running in its own thread with its own connection.
  */
 class saver
 {
 public:
+    /*!
+     * Writer pointer typedef.
+     */
+    using writer_ptr = std::unique_ptr<writer>;
+
+    /*!
+     * Saver statistics.
+     */
+    struct stats_type
+    {
+        /*!
+         * Number of tracker id lookups in a database.
+         */
+        std::atomic<uint64_t> lookups { 0 };
+
+        /*!
+         * Number of lookups which found no tracker.
+         */
+        std::atomic<uint64_t> unknown { 0 };
+
+        /*!
+         * Number of dropped reports, mostly of unknown trackers.
+         */
+        std::atomic<uint64_t> dropped { 0 };
+
+        /*!
+         * Number of reports written to the spool.
+         */
+        std::atomic<uint64_t> spooled { 0 };
+
+        /*!
+         * Number of reports replayed from the spool.
+         */
+        std::atomic<uint64_t> replayed { 0 };
+
+        /*!
+         * Number of retransmitted reports not written again.
+         */
+        std::atomic<uint64_t> duplicates { 0 };
+
+        /*!
+         * Number of keep-alive reports.
+         */
+        std::atomic<uint64_t> alive { 0 };
+
+        /*!
+         * Number of tracker states written by bulk upserts.
+         */
+        std::atomic<uint64_t> states { 0 };
+
+        /*!
+         * Number of reports dropped because the saver or writer queues
+         * were full and could not be spilled.
+         */
+        std::atomic<uint64_t> overflows { 0 };
+
+        /*!
+         * Statistics output.
+         * \param os
+         * \param s
+         * \return
+         */
+        friend
+        std::ostream& operator<<(std::ostream& os, stats_type const& s)
+        {
+            os <<
+                "lookups " << s.lookups << ", " <<
+                "unknown " << s.unknown << ", " <<
+                "dropped " << s.dropped << ", " <<
+                "spooled " << s.spooled << ", " <<
+                "replayed " << s.replayed << ", " <<
+                "duplicates " << s.duplicates << ", " <<
+                "alive " << s.alive << ", " <<
+                "states " << s.states << ", " <<
+                "overflows " << s.overflows;
+
+            return os;
+        }
+    };
+
     /*!
      * Constructor.
-     * \param db Database connections.
+     * \param db Database connections of writers, empty in the asynchronous
+     *           mode.
+     * \param states_db Database connection for trackers states.
+     * \param lookup_db Connection strings of databases to look tracker
+     *                  ids up in, the first one loads all ids at start.
+     * \param shards Database shards, in the order of `db` connections,
+     *                a writer is created for each.
+     * \param workers Number of workers, each of them reads tracker ids
+     *                from the registry.
+     * \param opts Saver settings.
+     * \throw error
      */
-    saver(ys::db::pool& db);
+    saver(ys::db::pool& db, ys::db::pool& states_db,
+          std::vector<std::string> const& lookup_db,
+          std::vector<config::db_shard> const& shards,
+          std::size_t workers, config::saver_options const& opts);
 
     /*!
      * Start the saver process.
@@ -39,63 +152,335 @@ public:
     run();
 
     /*!
-     * Interrupt execution.
+     * Interrupt execution, queued reports are saved or spooled if there
+     * is a spool.
      */
     void
     interrupt();
 
     /*!
-     * Add data to the saver queue.
-     * \param d
+     * Move a batch of data to the saver queue.
+     * \param batch Reports to add, the vector is cleared.
      */
     void
-    push(parser::data_type const& d);
+    push(std::vector<report>& batch);
+
+    /*!
+     * Check whether the report is a retransmit of a saved one.
+     * \param id Tracker id.
+     * \param d
+     * \return
+     */
+    bool
+    duplicate(uint32_t id, report const& d);
+
+    /*!
+     * Get delivery tickets of reports waiting to be committed.
+     * \return
+     */
+    ack_table&
+    acks();
+
+    /*!
+     * Get tracker ids shared with workers.
+     * \return
+     */
+    tracker_registry&
+    registry();
+
+    /*!
+     * Get shard writers.
+     * \return
+     */
+    std::vector<writer_ptr> const&
+    writers() const;
+
+    /*!
+     * Get saver statistics.
+     * \return
+     */
+    stats_type const&
+    stats() const;
 
 private:
     /*!
      * Queue typedef.
      */
-    using queue_type = ys::blocking_queue<parser::data_type>;
+    using queue_type = mpsc_ring<report>;
+
+    /*!
+     * A typedef for a batch of reports taken from the queue.
+     */
+    using batch_type = std::vector<report>;
 
     /*!
-     * A typedef for trackers identifiers caching container.
+     * Clock typedef.
      */
-    using id_cache_type = std::map<std::string, uint32_t>;
+    using clock_type = std::chrono::steady_clock;
 
     /*!
-     * Pool of db connections.
+     * Database connection for trackers states.
      */
-    ys::db::pool& db_;
+    ys::db::pool& states_db_;
 
     /*!
-     * A queue of trackers data items to update.
+     * Connection string of a database to load all tracker ids from.
+     */
+    std::string ids_db_;
+
+    /*!
+     * Saver settings.
+     */
+    config::saver_options opts_;
+
+    /*!
+     * Delivery tickets of reports waiting to be committed.
+     */
+    ack_table acks_;
+
+    /*!
+     * Shard writers.
+     */
+    std::vector<writer_ptr> writers_;
+
+    /*!
+     * Trackers placement on shards.
+     */
+    shard_ring ring_;
+
+    /*!
+     * A queue of live reports.
      */
     queue_type queue_;
 
     /*!
-     * Trackers identifiers caching container.
+     * A queue of backlog reports, taken when there are no live ones and
+     * every few batches while there are.
+     */
+    queue_type bulk_;
+
+    /*!
+     * Trackers identifiers, including the ones known to be missing
+     * in a database.
+     */
+    id_table ids_;
+
+    /*!
+     * Snapshots of tracker ids shared with workers.
+     */
+    tracker_registry registry_;
+
+    /*!
+     * Tracker ids changed since the last publication.
      */
-    id_cache_type id_cache_;
+    bool ids_changed_ { false };
 
     /*!
-     * Save parser data in database.
+     * Time of the last tracker ids publication.
+     */
+    clock_type::time_point publish_time_;
+
+    /*!
+     * Filter of retransmitted reports.
+     */
+    dedup_window dedup_;
+
+    /*!
+     * Latest states of trackers not flushed yet.
+     */
+    state_table states_;
+
+    /*!
+     * Tracker ids resolver.
+     */
+    std::unique_ptr<resolver> resolver_;
+
+    /*!
+     * Resolved tracker ids taken from the resolver.
+     */
+    std::vector<resolver::request> resolved_;
+
+    /*!
+     * Reports waiting for their tracker ids to be resolved, by trackers.
+     */
+    std::unordered_map<std::string, batch_type> parked_;
+
+    /*!
+     * Number of parked reports.
+     */
+    std::size_t parked_size_ { 0 };
+
+    /*!
+     * Tracker ids snapshot loader, set when snapshots are enabled.
+     */
+    std::unique_ptr<id_loader> loader_;
+
+    /*!
+     * Reports spool, set when spooling is enabled.
+     */
+    std::unique_ptr<spool> spool_;
+
+    /*!
+     * Interruption flag.
+     */
+    std::atomic<bool> interrupted_ { false };
+
+    /*!
+     * Time of the last expired unknown trackers removal.
+     */
+    clock_type::time_point purge_time_;
+
+    /*!
+     * Time of the last tracker states flush.
+     */
+    clock_type::time_point flush_time_;
+
+    /*!
+     * Saver statistics.
+     */
+    stats_type stats_;
+
+    /*!
+     * Time of the last statistics report.
+     */
+    clock_type::time_point stats_time_;
+
+    /*!
+     * Get a lane of the report by its age.
+     * \param d
+     * \param now Current time.
+     * \return
+     */
+    lane
+    classify(report const& d, int64_t now) const;
+
+    /*!
+     * Move a range of reports to a queue, spilling them to the spool
+     * when required.
+     *
+     * The worker thread is never blocked, reports which fit neither
+     * the spool nor any queue are dropped.
+     *
+     * \param queue
+     * \param first
+     * \param last
+     */
+    void
+    push(queue_type& queue, batch_type::iterator first,
+         batch_type::iterator last);
+
+    /*!
+     * Write a range of reports to the spool.
+     * \param first
+     * \param last
+     * \return Number of spooled reports, the first ones of the range.
+     */
+    std::size_t
+    spill(batch_type::iterator first, batch_type::iterator last);
+
+    /*!
+     * Write a batch of reports to the spool, the ones which cannot be
+     * spooled are dropped.
+     * \param batch
+     * \return Number of dropped reports.
+     */
+    std::size_t
+    spill_or_drop(batch_type& batch);
+
+    /*!
+     * Read a batch of reports from the spool to be saved.
+     * \param batch Output vector, reports are appended to it.
+     * \return Number of read reports.
+     */
+    std::size_t
+    unspool(batch_type& batch);
+
+    /*!
+     * Check whether the database falls behind, so that new reports must go
+     * to the spool.
+     * \return
+     */
+    bool
+    pressure() const;
+
+    /*!
+     * Fill the tracker ids cache from the snapshot or with a bulk query.
+     */
+    void
+    warm_up();
+
+    /*!
+     * Replace the tracker ids cache with loaded ids, keeping the entries
+     * of missing trackers.
+     * \param ids
+     */
+    void
+    fill(id_loader::cache_type const& ids);
+
+    /*!
+     * Resolve tracker ids of a batch of reports and route them to lanes
+     * of writers.
+     * \param batch
      */
     void
-    save(parser::data_type const& d);
+    dispatch(batch_type& batch);
 
     /*!
-     * Get tracker id from `num` or `phone`, and `type`.
-     * \param num
-     * \param phone
-     * \param type
+     * Get tracker id from the report number and type.
+     *
+     * An id missing in the cache is requested from the resolver.
+     *
+     * \param d
+     * \return Tracker id, 0 for unknown trackers or `pending_id` while
+     *         the id is being resolved.
      */
     uint32_t
-    get_id(std::string const& num, std::string const& phone,
-            std::string const& type);
+    get_id(report const& d);
+
+    /*!
+     * Set a report aside until its tracker id is resolved.
+     * \param d
+     * \param overflow Reports past the parking limit, the report is added
+     *        to it if there is no room.
+     */
+    void
+    park(report const& d, batch_type& overflow);
+
+    /*!
+     * Put resolved tracker ids into the cache and dispatch reports which
+     * were waiting for them.
+     */
+    void
+    resolve();
+
+    /*!
+     * Remove expired entries of unknown trackers.
+     */
+    void
+    purge_unknown();
+
+    /*!
+     * Publish changed tracker ids to workers.
+     * \param force Publish regardless of the publication interval.
+     */
+    void
+    publish_ids(bool force);
+
+    /*!
+     * Write changed tracker states with one bulk upsert.
+     * \param force Flush regardless of the flush interval.
+     */
+    void
+    flush_states(bool force);
+
+    /*!
+     * Log statistics if the reporting interval has passed.
+     */
+    void
+    report_stats();
 };
 
 } // namespace td
 } // namespace ys
 
 #endif // YS_TD_SAVER_H
-
@@ -0,0 +1,77 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Consistent hash ring of database shards header file.
+ */
+
+#ifndef YS_TD_SHARD_RING_H
+#define YS_TD_SHARD_RING_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ys/td/config.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A consistent hash ring mapping tracker ids to database shards.
+ *
+ * Every shard owns a number of points on the ring proportional to its
+ * weight, a tracker belongs to the shard owning the first point after
+ * the tracker's hash. Points depend on shard names only, so adding
+ * a shard moves about 1/N of trackers and reordering shards in the config
+ * moves none.
+ */
+class shard_ring
+{
+public:
+    /*!
+     * Number of ring points per a unit of shard weight.
+     */
+    static const unsigned points_per_weight = 160;
+
+    /*!
+     * Constructor.
+     * \param shards Database shards, in the order of connections.
+     * \throw error
+     */
+    explicit
+    shard_ring(std::vector<config::db_shard> const& shards);
+
+    /*!
+     * Get a shard of a tracker.
+     * \param id Tracker id.
+     * \return Shard index.
+     */
+    std::size_t
+    shard(uint32_t id) const;
+
+    /*!
+     * Get a number of shards.
+     * \return
+     */
+    std::size_t
+    size() const;
+
+private:
+    /*!
+     * Ring points and their shards, ordered by points.
+     */
+    std::vector<std::pair<uint64_t, std::size_t>> points_;
+
+    /*!
+     * Number of shards.
+     */
+    std::size_t size_;
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_SHARD_RING_H
@@ -0,0 +1,209 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Durable reports spool class header file.
+ */
+
+#ifndef YS_TD_SPOOL_H
+#define YS_TD_SPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ys/td/report.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Append-only spool of reports on a local disk.
+ *
+ * Reports are appended to memory-mapped segment files of a fixed size
+ * and read back in the same order. Appended reports are on the disk once
+ * `sync` returns. A read moves a cursor in memory only, its position
+ * is stored in the segment header when the read is committed, that is
+ * when the read reports are saved, so reports which are read but not
+ * saved yet are read again after a restart. The header is written back
+ * lazily, a power loss may have some saved reports read again, but
+ * never loses them. A segment is removed once it is read through and
+ * committed.
+ */
+class spool
+{
+public:
+    /*!
+     * Constructor, opens segments left by a previous run.
+     * \param dir Spool directory.
+     * \param segment_size Size of a segment file in bytes.
+     * \throw error
+     */
+    spool(std::string const& dir, std::size_t segment_size);
+
+    /*!
+     * Destructor.
+     */
+    ~spool();
+
+    /*!
+     * Append a report.
+     * \param d
+     * \throw error
+     */
+    void
+    push(report const& d);
+
+    /*!
+     * Write appended reports to the disk.
+     * \throw error
+     */
+    void
+    sync();
+
+    /*!
+     * Read up to `max` reports in the order they were appended.
+     * \param out Output vector, reports are appended to it.
+     * \param max Maximum number of reports to read.
+     * \param mark Output mark of the read to commit, 0 if nothing was
+     *             read.
+     * \return Number of read reports.
+     */
+    std::size_t
+    pop(std::vector<report>& out, std::size_t max, uint64_t& mark);
+
+    /*!
+     * Commit a read once its reports are saved, the read position is
+     * stored when all the preceding reads are committed too.
+     * \param mark Mark of the read, 0 is ignored.
+     */
+    void
+    commit(uint64_t mark);
+
+    /*!
+     * Get a number of unread reports.
+     * \return
+     */
+    std::size_t
+    size() const;
+
+private:
+    /*!
+     * Memory-mapped segment file.
+     */
+    struct segment;
+
+    /*!
+     * Segment pointer typedef.
+     */
+    using segment_ptr = std::unique_ptr<segment>;
+
+    /*!
+     * Read waiting to be committed.
+     */
+    struct read_mark
+    {
+        /*!
+         * Sequence number of the segment of the last read report.
+         */
+        uint64_t seq;
+
+        /*!
+         * Offset past the last read report.
+         */
+        std::size_t pos;
+
+        /*!
+         * Whether the read is committed.
+         */
+        bool done;
+    };
+
+    /*!
+     * Spool directory.
+     */
+    std::string dir_;
+
+    /*!
+     * Size of a segment file.
+     */
+    std::size_t segment_size_;
+
+    /*!
+     * Open segments, the first one is read and the last one is written.
+     */
+    std::deque<segment_ptr> segments_;
+
+    /*!
+     * Sequence number of the next segment.
+     */
+    uint64_t next_seq_ { 0 };
+
+    /*!
+     * Reads waiting to be committed, in the order of reading.
+     */
+    std::deque<read_mark> marks_;
+
+    /*!
+     * Mark of the first read waiting to be committed.
+     */
+    uint64_t first_mark_ { 1 };
+
+    /*!
+     * Number of unread reports.
+     */
+    std::atomic<std::size_t> size_ { 0 };
+
+    /*!
+     * Segments access mutex.
+     */
+    mutable std::mutex mutex_;
+
+    /*!
+     * Open a segment file, create it if required.
+     * \param seq Segment sequence number.
+     * \param create Create a new segment.
+     * \return
+     * \throw error
+     */
+    segment_ptr
+    open(uint64_t seq, bool create);
+
+    /*!
+     * Remove committed segments, except the last one which is being
+     * written.
+     */
+    void
+    trim();
+
+    /*!
+     * Encode a report.
+     * \param d
+     * \param buf Output buffer.
+     * \throw error
+     */
+    static
+    void
+    encode(report const& d, std::string& buf);
+
+    /*!
+     * Decode a report.
+     * \param p Encoded report.
+     * \param n Encoded report size.
+     * \param d Output report.
+     * \return False if the record is not a report.
+     */
+    static
+    bool
+    decode(char const* p, std::size_t n, report& d);
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_SPOOL_H
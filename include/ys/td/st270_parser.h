@@ -8,10 +8,8 @@
 #ifndef YS_TD_ST270_PARSER_H
 #define YS_TD_ST270_PARSER_H
 
-#include <functional>
-#include <locale>
-
 #include <ys/td/parser.h>
+#include <ys/td/tokenizer.h>
 
 namespace ys
 {
@@ -33,78 +31,30 @@ public:
     parse() override;
 
 private:
-    /*!
-     * Locale for reading datetime strings.
-     */
-    std::locale in_loc;
-
-    /*!
-     * Locale for writing datetime strings.
-     */
-    std::locale out_loc;
-
-    /*!
-     * Get ST270 report string.
-    * \return
-     */
-    std::string
-    get_report_string();
-
     /*!
      * Parse report string.
-     * \param s
+     * \param s Report line, it refers to the parser buffer.
      * \return
      */
     parser::result_type
-    parse_report(std::string const& s);
+    parse_report(tokenizer::field_type s);
 
     /*!
-     * Get function for reading packet data.
+     * Check whether the header is one of a report with position data.
      * \param hdr Packet header.
      * \return
      */
-    std::function<bool(std::vector<std::string>&)>
-    get_read_fn(std::string const& hdr);
-
-    /*!
-     * Read status report data.
-     * \param v Vector with report values.
-     * \return
-     */
-    bool
-    read_status_report(std::vector<std::string>& v);
-
-    /*!
-     * Read emergency report data.
-     * \param v Vector with report values.
-     * \return
-     */
-    bool
-    read_emergency_report(std::vector<std::string>& v);
-
-    /*!
-     * Read event report data.
-     * \param v Vector with report values.
-     * \return
-     */
-    bool
-    read_event_report(std::vector<std::string>& v);
-
-    /*!
-     * Read alert report data.
-     * \param v Vector with report values.
-     * \return
-     */
+    static
     bool
-    read_alert_report(std::vector<std::string>& v);
+    has_position(tokenizer::field_type hdr);
 
     /*!
      * Read data from the report packet.
-     * \param v Vector of report values.
+     * \param v Report values.
      * \return
      */
     bool
-    read_report_data(std::vector<std::string>& v);
+    read_report_data(tokenizer const& v);
 };
 
 } // namespace td
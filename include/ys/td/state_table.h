@@ -0,0 +1,126 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Trackers latest state table header file.
+ */
+
+#ifndef YS_TD_STATE_TABLE_H
+#define YS_TD_STATE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <ys/td/report.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A table of the latest known state of every tracker.
+ *
+ * Reports coalesce into one entry per tracker, entries changed since
+ * the last flush are handed out with `take`. It is used by a single
+ * thread.
+ */
+class state_table
+{
+public:
+    /*!
+     * Tracker state.
+     */
+    struct entry
+    {
+        /*!
+         * Tracker id.
+         */
+        uint32_t id;
+
+        /*!
+         * The latest position report.
+         */
+        report fix;
+
+        /*!
+         * A position report was received.
+         */
+        bool has_fix;
+
+        /*!
+         * Time of the latest report of any kind, seconds since the epoch.
+         */
+        int64_t last_seen;
+    };
+
+    /*!
+     * Update the tracker state with a report.
+     * \param id Tracker id.
+     * \param d
+     */
+    void
+    update(uint32_t id, report const& d);
+
+    /*!
+     * Move states changed since the last call into `out`.
+     * \param out Output vector, states are appended to it.
+     */
+    void
+    take(std::vector<entry>& out);
+
+    /*!
+     * Mark states as changed again, e.g. after a failed flush.
+     * \param states
+     */
+    void
+    restore(std::vector<entry> const& states);
+
+    /*!
+     * Get a number of changed states.
+     * \return
+     */
+    std::size_t
+    dirty() const;
+
+private:
+    /*!
+     * Table item.
+     */
+    struct item
+    {
+        /*!
+         * Tracker state.
+         */
+        entry state;
+
+        /*!
+         * The state changed since the last flush.
+         */
+        bool dirty;
+    };
+
+    /*!
+     * Trackers states by tracker ids.
+     */
+    std::unordered_map<uint32_t, item> items_;
+
+    /*!
+     * Ids of changed states.
+     */
+    std::vector<uint32_t> dirty_;
+
+    /*!
+     * Get an item of the tracker, marking it changed.
+     * \param id
+     * \return
+     */
+    item&
+    touch(uint32_t id);
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_STATE_TABLE_H
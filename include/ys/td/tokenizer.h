@@ -0,0 +1,109 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Allocation free report tokenizer header file.
+ */
+
+#ifndef YS_TD_TOKENIZER_H
+#define YS_TD_TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <boost/utility/string_ref.hpp>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A line split into fields referring to the line.
+ *
+ * Fields are kept inline, splitting a line does no heap allocation and
+ * copies nothing, so the line must outlive the tokenizer.
+ */
+class tokenizer
+{
+public:
+    /*!
+     * Field typedef.
+     */
+    using field_type = boost::string_ref;
+
+    /*!
+     * Maximum number of fields, the last one holds the rest of a longer
+     * line.
+     */
+    static const std::size_t max_fields = 40;
+
+    /*!
+     * Split a line.
+     * \param s Line.
+     * \param d Delimiter.
+     */
+    tokenizer(field_type s, char d);
+
+    /*!
+     * Get a number of fields.
+     * \return
+     */
+    std::size_t
+    size() const;
+
+    /*!
+     * Get a field.
+     * \param i Field index.
+     * \return Empty field if there is no such field.
+     */
+    field_type
+    operator[](std::size_t i) const;
+
+private:
+    /*!
+     * Fields.
+     */
+    field_type fields_[max_fields];
+
+    /*!
+     * Number of fields.
+     */
+    std::size_t size_ { 0 };
+};
+
+/*!
+ * Read a leading integer of a field the way a stream does, "15.30"
+ * is read as 15.
+ * \param s
+ * \param v Output value, 0 if the field does not start with a number.
+ * \return False if the value does not fit.
+ */
+bool
+parse_int(tokenizer::field_type s, int64_t& v);
+
+/*!
+ * Read a decimal fraction scaled by `10^digits` and rounded half away
+ * from zero, "+37.4786285" with 6 digits is read as 37478629.
+ * \param s
+ * \param digits Number of fraction digits kept.
+ * \param v Output value, 0 if the field does not start with a number.
+ * \return False if the value does not fit.
+ */
+bool
+parse_fixed(tokenizer::field_type s, unsigned digits, int64_t& v);
+
+/*!
+ * Get seconds since the epoch of a UTC date and time.
+ * \param date Date in `YYYYMMDD` format.
+ * \param time Time in `HH:MM:SS` format.
+ * \param epoch Output value.
+ * \return False if the date or time is not valid.
+ */
+bool
+parse_epoch(tokenizer::field_type date, tokenizer::field_type time,
+            int64_t& epoch);
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_TOKENIZER_H
@@ -0,0 +1,183 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids registry shared between threads header file.
+ */
+
+#ifndef YS_TD_TRACKER_REGISTRY_H
+#define YS_TD_TRACKER_REGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ys/td/id_table.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Read-mostly tracker ids registry.
+ *
+ * A single writer publishes immutable snapshots of an id table, any
+ * number of readers look ids up in the latest snapshot without locks.
+ * A reader announces the epoch it reads in and a replaced snapshot is
+ * freed only once no reader may still be in it, so a lookup is a few
+ * atomic operations and never waits for the writer.
+ */
+class tracker_registry
+{
+public:
+    /*!
+     * Maximum number of readers. Slots are scanned by every `reclaim`,
+     * so the number is kept small, a reader thread per core is plenty.
+     */
+    static const std::size_t max_readers = 64;
+
+    /*!
+     * A reader slot, each reading thread holds its own.
+     */
+    class reader
+    {
+    public:
+        /*!
+         * Take a free reader slot.
+         * \param r Registry.
+         * \throw error If all slots are taken.
+         */
+        explicit
+        reader(tracker_registry& r);
+
+        /*!
+         * Release the slot.
+         */
+        ~reader();
+
+        reader(reader const&) = delete;
+        reader& operator=(reader const&) = delete;
+
+        /*!
+         * Find a tracker in the latest snapshot.
+         * \param k Key.
+         * \param v Output value.
+         * \return False if there is no such tracker.
+         */
+        bool
+        find(id_table::key_type const& k, id_table::value_type& v);
+
+    private:
+        /*!
+         * Registry.
+         */
+        tracker_registry& registry_;
+
+        /*!
+         * Slot index.
+         */
+        std::size_t slot_;
+    };
+
+    /*!
+     * Constructor, the registry starts with an empty snapshot.
+     * \param readers Number of reader threads to be, there may be
+     *                no more than `max_readers` of them.
+     * \throw error If there are too many readers.
+     */
+    explicit
+    tracker_registry(std::size_t readers);
+
+    /*!
+     * Destructor.
+     */
+    ~tracker_registry();
+
+    tracker_registry(tracker_registry const&) = delete;
+    tracker_registry& operator=(tracker_registry const&) = delete;
+
+    /*!
+     * Publish a copy of the table as the latest snapshot. Must be called
+     * from the writer thread only.
+     * \param table
+     */
+    void
+    publish(id_table const& table);
+
+    /*!
+     * Free replaced snapshots no reader is in. Must be called from
+     * the writer thread only.
+     * \return Number of snapshots still waiting for readers.
+     */
+    std::size_t
+    reclaim();
+
+    /*!
+     * Get a number of published snapshots.
+     * \return
+     */
+    uint64_t
+    snapshots() const;
+
+private:
+    /*!
+     * Reader slot, on its own cache line so that readers do not slow
+     * each other down.
+     */
+    struct alignas(64) slot
+    {
+        /*!
+         * The slot is taken.
+         */
+        std::atomic<bool> taken { false };
+
+        /*!
+         * Epoch the reader is in, 0 when the reader is outside.
+         */
+        std::atomic<uint64_t> epoch { 0 };
+    };
+
+    /*!
+     * Replaced snapshot waiting for readers to leave it.
+     */
+    struct retired
+    {
+        /*!
+         * Snapshot.
+         */
+        std::unique_ptr<id_table const> table;
+
+        /*!
+         * The last epoch readers could have entered the snapshot in.
+         */
+        uint64_t epoch;
+    };
+
+    /*!
+     * The latest snapshot.
+     */
+    std::atomic<id_table const*> current_;
+
+    /*!
+     * Current epoch, advanced by every publication.
+     */
+    std::atomic<uint64_t> epoch_ { 1 };
+
+    /*!
+     * Reader slots.
+     */
+    slot slots_[max_readers];
+
+    /*!
+     * Replaced snapshots, owned by the writer.
+     */
+    std::vector<retired> retired_;
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_TRACKER_REGISTRY_H
@@ -9,12 +9,16 @@
 #define YS_TD_WORKER_H
 
 #include <array>
+#include <deque>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include <ys/asio/basic_worker.h>
 #include <ys/td/config.h>
 #include <ys/td/saver.h>
 #include <ys/td/parser.h>
+#include <ys/td/tracker_registry.h>
 
 namespace ys
 {
@@ -83,6 +87,38 @@ private:
      */
     using sessions_type = std::map<tcp_conn_ptr, parser_ptr>;
 
+    /*!
+     * A reply held until the reports it acknowledges are committed.
+     */
+    struct held_reply
+    {
+        /*!
+         * Delivery ticket of the reports, 0 if the reply acknowledges
+         * nothing.
+         */
+        uint32_t ticket;
+
+        /*!
+         * Reply bytes.
+         */
+        parser::buffer_type bytes;
+
+        /*!
+         * The reports are committed, the reply may be sent.
+         */
+        bool ready;
+    };
+
+    /*!
+     * A typedef for replies of a connection in the order they are sent.
+     */
+    using held_type = std::deque<held_reply>;
+
+    /*!
+     * A typedef for held replies of connections.
+     */
+    using held_map_type = std::map<tcp_conn_ptr, std::shared_ptr<held_type>>;
+
     /*!
      * Connection data handler.
      */
@@ -108,6 +144,21 @@ private:
      */
     sessions_type sessions_;
 
+    /*!
+     * Parsed reports not handed to the saver yet.
+     */
+    std::vector<report> batch_;
+
+    /*!
+     * Reader of tracker ids published by the saver.
+     */
+    tracker_registry::reader ids_;
+
+    /*!
+     * Held replies of connections acknowledged after commit.
+     */
+    held_map_type held_;
+
     /*!
      * Get a parser pointer associated with specified connection pointer.
      */
@@ -129,6 +180,40 @@ private:
      */
     void
     send_response(parser_ptr p, tcp_conn_ptr c) const;
+
+    /*!
+     * Check whether the report needs not be saved, it is a keep-alive
+     * while tracker states are not kept, its tracker is known to be
+     * missing in a database or it is a retransmit of a saved one.
+     * \param d
+     * \return
+     */
+    bool
+    redundant(report const& d);
+
+    /*!
+     * Open a delivery ticket for reports of the connection.
+     * \param c Connection.
+     * \return
+     */
+    uint32_t
+    open_ticket(tcp_conn_ptr c);
+
+    /*!
+     * Mark a reply of the connection ready once its ticket is done.
+     * \param conn Connection, it may be lost by now.
+     * \param ticket Done ticket.
+     */
+    void
+    on_ticket_done(std::weak_ptr<tcp_conn_type> conn, uint32_t ticket);
+
+    /*!
+     * Send ready replies of the connection up to the first held one.
+     * \param c Connection.
+     * \param replies Replies of the connection.
+     */
+    void
+    send_ready(tcp_conn_ptr c, held_type& replies) const;
 };
 
 } // namespace td
@@ -0,0 +1,480 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Database shard writer class header file.
+ */
+
+#ifndef YS_TD_WRITER_H
+#define YS_TD_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ys/td/ack_table.h>
+#include <ys/td/config.h>
+#include <ys/td/copier.h>
+#include <ys/td/dedup_window.h>
+#include <ys/td/lane_queue.h>
+#include <ys/td/report.h>
+#include <ys/td/spool.h>
+#include <ys/db/async_conn.h>
+#include <ys/db/pool.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * A class writing reports into a single database shard.
+ *
+ * Every writer owns its connection and its input queue and is supposed
+ * to be run in a dedicated thread, or to be started on an event loop
+ * shared by many writers in the asynchronous mode.
+ */
+class writer
+{
+public:
+    /*!
+     * A typedef for a report with resolved tracker id.
+     */
+    using row_type = std::pair<uint32_t, report>;
+
+    /*!
+     * Writer statistics.
+     */
+    struct stats_type
+    {
+        /*!
+         * Number of committed batches.
+         */
+        std::atomic<uint64_t> batches { 0 };
+
+        /*!
+         * Number of saved reports.
+         */
+        std::atomic<uint64_t> reports { 0 };
+
+        /*!
+         * Size of the largest batch.
+         */
+        std::atomic<uint64_t> max_batch { 0 };
+
+        /*!
+         * Total time of batch commits in microseconds.
+         */
+        std::atomic<uint64_t> commit_time { 0 };
+
+        /*!
+         * Longest batch commit in microseconds.
+         */
+        std::atomic<uint64_t> max_commit_time { 0 };
+
+        /*!
+         * Latest batch commit in microseconds.
+         */
+        std::atomic<uint64_t> last_commit_time { 0 };
+
+        /*!
+         * Number of reports failed to be saved.
+         */
+        std::atomic<uint64_t> errors { 0 };
+
+        /*!
+         * Number of reports moved to the spool when stopping.
+         */
+        std::atomic<uint64_t> spooled { 0 };
+
+        /*!
+         * Number of reports sent again after the connection was lost
+         * with their commit in doubt, they may be saved twice.
+         */
+        std::atomic<uint64_t> in_doubt { 0 };
+
+        /*!
+         * Age in seconds of the newest report of the latest live batch
+         * when it was committed.
+         */
+        std::atomic<int64_t> live_lag { 0 };
+
+        /*!
+         * Age in seconds of the newest report of the latest bulk batch
+         * when it was committed.
+         */
+        std::atomic<int64_t> bulk_lag { 0 };
+
+        /*!
+         * Statistics output.
+         * \param os
+         * \param s
+         * \return
+         */
+        friend
+        std::ostream& operator<<(std::ostream& os, stats_type const& s)
+        {
+            uint64_t batches = s.batches;
+
+            os <<
+                "batches " << batches << ", " <<
+                "reports " << s.reports << ", " <<
+                "avg batch " << (batches ? s.reports / batches : 0) << ", " <<
+                "max batch " << s.max_batch << ", " <<
+                "avg commit " <<
+                (batches ? s.commit_time / batches : 0) << "us, " <<
+                "max commit " << s.max_commit_time << "us, " <<
+                "errors " << s.errors << ", " <<
+                "spooled " << s.spooled << ", " <<
+                "in doubt " << s.in_doubt << ", " <<
+                "live lag " << s.live_lag << "s, " <<
+                "bulk lag " << s.bulk_lag << "s";
+
+            return os;
+        }
+    };
+
+    /*!
+     * Constructor.
+     * \param db Shard connections, not used in the asynchronous mode.
+     * \param shard Index of the shard connection in the pool.
+     * \param conn_str Connection string of the shard.
+     * \param opts Saver settings.
+     * \param acks Delivery tickets of reports waiting to be committed.
+     * \param spool Spool to move queued reports to when stopping,
+     *              nullptr if there is none.
+     * \param dedup Filter of retransmitted reports, committed reports
+     *              are added to it.
+     */
+    writer(ys::db::pool& db, std::size_t shard,
+           std::string const& conn_str,
+           config::saver_options const& opts, ack_table& acks,
+           spool* spool, dedup_window& dedup);
+
+    /*!
+     * Declare statements used by writers on the pool connections.
+     * \param db
+     */
+    static
+    void
+    prepare(ys::db::pool& db);
+
+    /*!
+     * Start the writer process.
+     */
+    void
+    run();
+
+    /*!
+     * Start the writer on an event loop instead of running it
+     * in a dedicated thread.
+     * \param io Event loop.
+     */
+    void
+    start(boost::asio::io_service& io);
+
+    /*!
+     * Interrupt execution once the queue is drained.
+     */
+    void
+    interrupt();
+
+    /*!
+     * Add a range of reports to a lane of the writer queue.
+     * \param l Lane.
+     * \param first
+     * \param last
+     */
+    template<typename Iterator>
+    void
+    push(lane l, Iterator first, Iterator last)
+    {
+        queue_.push(l, first, last);
+
+        if (io_)
+        {
+            io_->post([this]()
+            {
+                kick();
+            });
+        }
+    }
+
+    /*!
+     * Get a number of reports waiting in the queue.
+     * \return
+     */
+    std::size_t
+    depth() const;
+
+    /*!
+     * Get a number of reports waiting in a lane of the queue.
+     * \param l Lane.
+     * \return
+     */
+    std::size_t
+    depth(lane l) const;
+
+    /*!
+     * Get writer statistics.
+     * \return
+     */
+    stats_type const&
+    stats() const;
+
+    /*!
+     * Get health of the shard connection.
+     * \return
+     */
+    ys::db::pool::health_type const&
+    health() const;
+
+private:
+    /*!
+     * Queue typedef.
+     */
+    using queue_type = lane_queue<row_type>;
+
+    /*!
+     * A typedef for a batch of reports taken from the queue.
+     */
+    using batch_type = std::vector<row_type>;
+
+    /*!
+     * Clock typedef.
+     */
+    using clock_type = std::chrono::steady_clock;
+
+    /*!
+     * Shard connections.
+     */
+    ys::db::pool& db_;
+
+    /*!
+     * Index of the shard connection in the pool.
+     */
+    std::size_t shard_;
+
+    /*!
+     * Connection string of the shard.
+     */
+    std::string conn_str_;
+
+    /*!
+     * Shard connection, not set in the asynchronous mode.
+     */
+    ys::db::pool::conn_ptr conn_;
+
+    /*!
+     * Interruption flag.
+     */
+    std::atomic<bool> interrupted_ { false };
+
+    /*!
+     * Delivery tickets of reports waiting to be committed.
+     */
+    ack_table& acks_;
+
+    /*!
+     * Spool to move queued reports to when stopping, may be nullptr.
+     */
+    spool* spool_;
+
+    /*!
+     * Filter of retransmitted reports.
+     */
+    dedup_window& dedup_;
+
+    /*!
+     * Binary COPY writer, set in the COPY ingest mode.
+     */
+    std::unique_ptr<copier> copier_;
+
+    /*!
+     * Event loop, set in the asynchronous mode.
+     */
+    boost::asio::io_service* io_ { nullptr };
+
+    /*!
+     * Non-blocking shard connection, set in the asynchronous mode.
+     */
+    std::unique_ptr<ys::db::async_conn> async_;
+
+    /*!
+     * Batch being saved in the asynchronous mode.
+     */
+    batch_type pending_;
+
+    /*!
+     * Lane of the pending batch.
+     */
+    lane pending_lane_ { lane::live };
+
+    /*!
+     * Index of the first pending report not saved yet.
+     */
+    std::size_t pos_ { 0 };
+
+    /*!
+     * Pending reports are saved one by one after the batch failed.
+     */
+    bool single_ { false };
+
+    /*!
+     * A batch is pending.
+     */
+    bool busy_ { false };
+
+    /*!
+     * Start time of the pending batch.
+     */
+    clock_type::time_point start_;
+
+    /*!
+     * Saver settings.
+     */
+    config::saver_options opts_;
+
+    /*!
+     * A queue of reports to write.
+     */
+    queue_type queue_;
+
+    /*!
+     * Writer statistics.
+     */
+    stats_type stats_;
+
+    /*!
+     * Save a batch of reports in a single transaction.
+     * \param batch Reports, the ones left unsaved when the connection
+     *              breaks stay in it.
+     * \return False if the connection is broken.
+     */
+    bool
+    save(batch_type& batch);
+
+    /*!
+     * Remember committed reports so that their retransmits are dropped.
+     * \param first
+     * \param last
+     */
+    void
+    remember(batch_type::const_iterator first,
+             batch_type::const_iterator last);
+
+    /*!
+     * Update statistics with a committed batch.
+     * \param size Batch size.
+     * \param start Start time of the batch.
+     */
+    void
+    record(std::size_t size, clock_type::time_point start);
+
+    /*!
+     * Take the next batch of the queue and send it to the shard
+     * in the asynchronous mode.
+     */
+    void
+    kick();
+
+    /*!
+     * Send pending reports to the shard in the asynchronous mode.
+     */
+    void
+    send();
+
+    /*!
+     * Handle a completion of pending reports in the asynchronous mode.
+     * \param e Error of the statement if any.
+     */
+    void
+    done(std::exception_ptr e);
+
+    /*!
+     * Continue writing once the shard connection is open.
+     */
+    void
+    resume();
+
+    /*!
+     * Spool the pending batch and queued reports, or give them up if
+     * there is no spool, when the writer is stopped while the shard
+     * is down.
+     */
+    void
+    drop();
+
+    /*!
+     * Move queued reports to the spool when the writer is stopped.
+     * \param batch Reports taken already, the queued ones are added
+     *              to them.
+     * \return False if there is no spool.
+     */
+    bool
+    spill_queue(batch_type& batch);
+
+    /*!
+     * Move reports to the spool instead of the shard.
+     * \param batch
+     * \return False if there is no spool.
+     */
+    bool
+    spill(batch_type const& batch);
+
+    /*!
+     * Update the lag of a lane with a committed batch.
+     * \param l Lane.
+     * \param batch
+     */
+    void
+    update_lag(lane l, batch_type const& batch);
+
+    /*!
+     * Release delivery tickets of a committed batch.
+     * \param batch
+     */
+    void
+    release(batch_type const& batch);
+
+    /*!
+     * Get time to wait for a live batch to fill up.
+     * \return
+     */
+    std::chrono::milliseconds
+    batch_wait() const;
+
+    /*!
+     * Wait for the shard connection to be reopened.
+     * \return False if the writer was interrupted while waiting.
+     */
+    bool
+    park();
+
+    /*!
+     * Execute inserts of the batch with one statement per `insert_chunk`
+     * reports.
+     * \param tx Transaction.
+     * \param batch
+     */
+    void
+    insert(pqxx::work& tx, batch_type const& batch);
+
+    /*!
+     * Execute an insert of the report.
+     * \param tx Transaction.
+     * \param row Report with resolved tracker id.
+     */
+    void
+    insert(pqxx::work& tx, row_type const& row);
+};
+
+} // namespace td
+} // namespace ys
+
+#endif // YS_TD_WRITER_H
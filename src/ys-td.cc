@@ -5,15 +5,100 @@
  * \brief  Trackers daemon
  */
 
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <thread>
+#include <vector>
+#include <boost/property_tree/json_parser.hpp>
+#include <pqxx/pqxx>
 #include <ys/asio/simple_server.h>
 #include <ys/db/pool.h>
 #include <ys/td/config.h>
+#include <ys/td/id_loader.h>
+#include <ys/td/shard_ring.h>
 #include <ys/td/worker.h>
 #include <ys/td/saver.h>
 
+namespace
+{
+
+/*!
+ * Print trackers which a new shards list would move to other shards.
+ * \param conf Application configuration with the current shards list.
+ * \return Exit code.
+ */
+int
+shard_dry_run(ys::td::config const& conf)
+{
+    /*!
+     * Config with the new shards list.
+     */
+    boost::property_tree::ptree tree;
+
+    boost::property_tree::read_json(conf.data.shard_dry_run, tree);
+
+    /*!
+     * New database shards.
+     */
+    std::vector<ys::td::config::db_shard> shards;
+
+    ys::td::config::load_shards(tree, shards);
+
+    ys::td::shard_ring before { conf.data.shards };
+    ys::td::shard_ring after { shards };
+
+    /*
+     * Tracker ids are taken from the snapshot if there is one,
+     * so the database isn't scanned on every run.
+     */
+    ys::td::id_loader::cache_type ids;
+
+    auto& s = conf.data.saver;
+
+    if (s.id_snapshot.empty() ||
+        !ys::td::id_loader { conf.data.lookup_db.front(), s.id_snapshot,
+                             s.id_snapshot_interval }.read(ids))
+    {
+        pqxx::connection conn { conf.data.lookup_db.front() };
+
+        ys::td::id_loader::load(conn, ids);
+    }
+
+    std::size_t total = 0;
+    std::size_t moved = 0;
+
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        uint32_t id = ids[i].id;
+
+        /*
+         * Entries are ordered by ids, a tracker with a sim number
+         * has several of them.
+         */
+        if (i > 0 && ids[i - 1].id == id)
+            continue;
+
+        ++total;
+
+        auto& from = conf.data.shards[before.shard(id)].name;
+        auto& to = shards[after.shard(id)].name;
+
+        if (from != to)
+        {
+            ++moved;
+            std::cout << id << ": " << from << " -> " << to << std::endl;
+        }
+    }
+
+    std::cout << "Moved " << moved << " of " << total << " trackers" <<
+              std::endl;
+
+    return 0;
+}
+
+} // namespace
+
 int
 main(int argc, char* argv[])
 {
@@ -22,15 +107,37 @@ main(int argc, char* argv[])
      */
     ys::td::config conf { argc, argv };
 
+    if (!conf.data.shard_dry_run.empty())
+        return shard_dry_run(conf);
+
+    /*!
+     * Maximum delay between database reconnection attempts.
+     */
+    std::chrono::milliseconds backoff { conf.data.saver.reconnect_backoff };
+
+    /*!
+     * Pool of db connections, writers of the asynchronous mode open
+     * their own ones.
+     */
+    ys::db::pool db_pool
+    {
+        conf.data.saver.async ? std::vector<std::string> {} : conf.data.db,
+        backoff
+    };
+
     /*!
-     * Pool of db connections.
+     * Connection for trackers states, separate from the writers' ones.
      */
-    ys::db::pool db_pool { conf.data.db };
+    ys::db::pool states_pool { { conf.data.db.front() }, backoff };
 
     /*!
      * Data saver.
      */
-    ys::td::saver saver { db_pool };
+    ys::td::saver saver
+    {
+        db_pool, states_pool, conf.data.lookup_db, conf.data.shards,
+        static_cast<std::size_t>(conf.data.w_count), conf.data.saver
+    };
 
     /*!
      * Functor for worker initialization.
@@ -41,7 +148,8 @@ main(int argc, char* argv[])
     };
 
     /*!
-     * Thread with running saver object.
+     * Thread with running saver object, it runs a thread per database
+     * connection on its own.
      */
     std::thread saver_thread
     {
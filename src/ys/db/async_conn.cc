@@ -0,0 +1,497 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Non-blocking database connection class source file.
+ */
+
+#include <ys/db/async_conn.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <pqxx/pqxx>
+
+#include <ys/logger.h>
+
+namespace ys
+{
+namespace db
+{
+
+namespace
+{
+
+/*!
+ * Delay before the first reconnection attempt.
+ */
+const std::chrono::milliseconds min_backoff { 100 };
+
+} // namespace
+
+/*!
+ * Constructor.
+ * \param io Event loop.
+ * \param conn_str Connection string.
+ * \param max_backoff Maximum delay between reconnection attempts.
+ */
+async_conn::async_conn(boost::asio::io_service& io,
+                       std::string const& conn_str,
+                       std::chrono::milliseconds max_backoff) :
+    io_ { io },
+    conn_str_ { conn_str },
+    socket_ { io },
+    timer_ { io },
+    backoff_ { min_backoff },
+    max_backoff_ { std::max(max_backoff, min_backoff) }
+{
+}
+
+/*!
+ * Destructor.
+ */
+async_conn::~async_conn()
+{
+    close();
+}
+
+/*!
+ * Declare a prepared statement, it is prepared on the connection
+ * every time it is opened.
+ * \param name Statement name.
+ * \param definition Statement SQL with `$n` parameters.
+ */
+void
+async_conn::prepare(std::string const& name, std::string const& definition)
+{
+    statements_.emplace_back(name, definition);
+}
+
+/*!
+ * Open the connection, retrying with a growing delay until it succeeds
+ * or the connection is closed.
+ * \param handler Handler called once the connection is open.
+ */
+void
+async_conn::open(open_handler_type handler)
+{
+    on_open_ = handler;
+    connect();
+}
+
+/*!
+ * Close the connection and cancel pending operations, their handlers
+ * are not called.
+ */
+void
+async_conn::close()
+{
+    boost::system::error_code ec;
+
+    socket_.close(ec);
+    timer_.cancel(ec);
+
+    on_open_ = nullptr;
+    on_done_ = nullptr;
+    health_.healthy = false;
+    ++generation_;
+
+    if (conn_)
+    {
+        PQfinish(conn_);
+        conn_ = nullptr;
+    }
+}
+
+/*!
+ * Execute a prepared statement.
+ * \param name Statement name.
+ * \param params Parameters in the text format.
+ * \param handler Completion handler.
+ */
+void
+async_conn::exec(std::string const& name,
+                 std::vector<std::string> const& params,
+                 handler_type handler)
+{
+    on_done_ = handler;
+    error_ = nullptr;
+
+    std::vector<char const*> values;
+
+    values.reserve(params.size());
+
+    for (auto& p: params)
+    {
+        values.push_back(p.c_str());
+    }
+
+    if (!health_.healthy ||
+        !PQsendQueryPrepared(conn_, name.c_str(), values.size(),
+                             values.data(), nullptr, nullptr, 0))
+    {
+        fail();
+        return;
+    }
+
+    flush();
+}
+
+/*!
+ * Get health of the connection.
+ * \return
+ */
+pool::health_type const&
+async_conn::health() const
+{
+    return health_;
+}
+
+/*!
+ * Start a connection attempt.
+ */
+void
+async_conn::connect()
+{
+    /*
+     * A new connection may get the number of the old socket, so the
+     * descriptor is always dropped.
+     */
+    boost::system::error_code ec;
+
+    socket_.close(ec);
+
+    if (conn_)
+        PQfinish(conn_);
+
+    conn_ = PQconnectStart(conn_str_.c_str());
+
+    if (!conn_ || PQstatus(conn_) == CONNECTION_BAD)
+    {
+        retry();
+        return;
+    }
+
+    poll(PGRES_POLLING_WRITING);
+}
+
+/*!
+ * Continue the connection attempt.
+ * \param status Status of the latest poll.
+ */
+void
+async_conn::poll(PostgresPollingStatusType status)
+{
+    switch (status)
+    {
+    case PGRES_POLLING_OK:
+        if (PQsetnonblocking(conn_, 1) != 0)
+        {
+            retry();
+            return;
+        }
+
+        /*
+         * Prepared statements live as long as the server session,
+         * a new connection gets them all again.
+         */
+        prepared_ = 0;
+        declare();
+
+        return;
+
+    case PGRES_POLLING_READING:
+        wait(false, [this]()
+        {
+            poll(PQconnectPoll(conn_));
+        });
+
+        return;
+
+    case PGRES_POLLING_WRITING:
+        wait(true, [this]()
+        {
+            poll(PQconnectPoll(conn_));
+        });
+
+        return;
+
+    default:
+        retry();
+        return;
+    }
+}
+
+/*!
+ * Prepare the next declared statement on the new connection, call
+ * the open handler once all of them are prepared.
+ */
+void
+async_conn::declare()
+{
+    if (prepared_ == statements_.size())
+    {
+        health_.healthy = true;
+        backoff_ = min_backoff;
+
+        if (opened_)
+        {
+            ++health_.reconnects;
+            YS_LOG(info) << "Database connection reopened";
+        }
+
+        opened_ = true;
+
+        if (on_open_)
+        {
+            auto handler = on_open_;
+
+            on_open_ = nullptr;
+            handler();
+        }
+
+        return;
+    }
+
+    auto& s = statements_[prepared_];
+
+    /*
+     * A statement failed to be prepared is tried again with the next
+     * connection, the error is logged there.
+     */
+    on_done_ = [this](std::exception_ptr e)
+    {
+        if (e)
+        {
+            retry();
+            return;
+        }
+
+        ++prepared_;
+        declare();
+    };
+
+    error_ = nullptr;
+
+    if (!PQsendPrepare(conn_, s.first.c_str(), s.second.c_str(), 0,
+                       nullptr))
+    {
+        fail();
+        return;
+    }
+
+    flush();
+}
+
+/*!
+ * Schedule the next connection attempt.
+ */
+void
+async_conn::retry()
+{
+    /*
+     * Connection strings may hold passwords, only the error is logged.
+     */
+    YS_LOG(error) << "Failed to open database connection: " <<
+                  (conn_ ? PQerrorMessage(conn_) : "out of memory");
+
+    timer_.expires_from_now(backoff_);
+    backoff_ = std::min(backoff_ * 2, max_backoff_);
+
+    timer_.async_wait([this](boost::system::error_code const& ec)
+    {
+        if (!ec)
+            connect();
+    });
+}
+
+/*!
+ * Send the pending statement to the server.
+ */
+void
+async_conn::flush()
+{
+    int r = PQflush(conn_);
+
+    if (r < 0)
+    {
+        fail();
+        return;
+    }
+
+    if (r > 0)
+    {
+        wait(true, [this]()
+        {
+            flush();
+        });
+
+        return;
+    }
+
+    receive();
+}
+
+/*!
+ * Read results of the pending statement.
+ */
+void
+async_conn::receive()
+{
+    if (!PQconsumeInput(conn_))
+    {
+        fail();
+        return;
+    }
+
+    for (;;)
+    {
+        /*
+         * Results are taken as they arrive, the end of the statement is
+         * waited for without blocking the loop.
+         */
+        if (PQisBusy(conn_))
+        {
+            wait(false, [this]()
+            {
+                receive();
+            });
+
+            return;
+        }
+
+        PGresult* r = PQgetResult(conn_);
+
+        if (!r)
+            break;
+
+        ExecStatusType status = PQresultStatus(r);
+
+        if (!error_ &&
+            (status == PGRES_BAD_RESPONSE || status == PGRES_FATAL_ERROR))
+        {
+            error_ = std::make_exception_ptr(
+                         std::runtime_error(PQresultErrorMessage(r)));
+        }
+
+        PQclear(r);
+    }
+
+    if (PQstatus(conn_) != CONNECTION_OK)
+    {
+        fail();
+        return;
+    }
+
+    complete(error_);
+}
+
+/*!
+ * Mark the connection broken and complete the pending statement.
+ */
+void
+async_conn::fail()
+{
+    std::string msg = conn_ ? PQerrorMessage(conn_) : "not connected";
+
+    if (health_.healthy)
+    {
+        YS_LOG(warning) << "Database connection is broken: " << msg;
+
+        health_.healthy = false;
+        ++health_.failures;
+
+        /*
+         * The first attempt is made right away, a connection is often
+         * broken by a server restart which is over by now.
+         */
+        backoff_ = min_backoff;
+    }
+
+    complete(std::make_exception_ptr(pqxx::broken_connection(msg)));
+}
+
+/*!
+ * Complete the pending statement.
+ * \param e
+ */
+void
+async_conn::complete(std::exception_ptr e)
+{
+    if (!on_done_)
+        return;
+
+    /*
+     * The handler is posted, so that it may start the next statement
+     * or reopen the connection right away.
+     */
+    auto handler = on_done_;
+    unsigned generation = generation_;
+
+    on_done_ = nullptr;
+
+    io_.post([this, handler, e, generation]()
+    {
+        if (generation == generation_)
+            handler(e);
+    });
+}
+
+/*!
+ * Wait for the socket to become readable or writable.
+ * \param write Wait for writability.
+ * \param handler
+ */
+void
+async_conn::wait(bool write, std::function<void()> handler)
+{
+    int fd = PQsocket(conn_);
+    struct stat st;
+
+    /*
+     * libpq may close its socket while connecting, trying the next host
+     * or going without SSL, and the new one may get the same number, so
+     * the socket is told by its inode.
+     */
+    bool same = socket_.is_open() && ::fstat(fd, &st) == 0 &&
+                st.st_dev == dev_ && st.st_ino == ino_;
+
+    if (!same)
+    {
+        /*
+         * The event loop owns a duplicate, libpq keeps closing its own
+         * socket.
+         */
+        boost::system::error_code ec;
+
+        socket_.close(ec);
+
+        if (::fstat(fd, &st) == 0)
+        {
+            socket_.assign(::dup(fd), ec);
+
+            dev_ = st.st_dev;
+            ino_ = st.st_ino;
+        }
+    }
+
+    /*
+     * Errors are left for libpq to find out, only cancellation
+     * stops the operation.
+     */
+    auto ready = [handler](boost::system::error_code const& ec, std::size_t)
+    {
+        if (ec != boost::asio::error::operation_aborted)
+            handler();
+    };
+
+    if (write)
+        socket_.async_write_some(boost::asio::null_buffers(), ready);
+    else
+        socket_.async_read_some(boost::asio::null_buffers(), ready);
+}
+
+} // namespace db
+} // namespace ys
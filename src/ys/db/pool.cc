@@ -7,25 +7,210 @@
 
 #include <ys/db/pool.h>
 
+#include <algorithm>
+#include <thread>
+
+#include <ys/logger.h>
+
 namespace ys
 {
 namespace db
 {
 
+namespace
+{
+
+/*!
+ * Delay before the first reconnection attempt.
+ */
+const std::chrono::milliseconds min_backoff { 100 };
+
+} // namespace
+
 /*!
- * Constructor.
+ * Constructor, opens all connections in parallel.
  * \param conn_str A list of connection strings.
+ * \param max_backoff Maximum delay between reconnection attempts.
  */
-pool::pool(std::vector<std::string> const& conn_str)
+pool::pool(std::vector<std::string> const& conn_str,
+           std::chrono::milliseconds max_backoff) :
+    conn_str_ { conn_str },
+    max_backoff_ { std::max(max_backoff, min_backoff) }
 {
     reserve(conn_str.size());
+    states_.reserve(conn_str.size());
 
     for (auto& s: conn_str)
     {
-        emplace_back(new pqxx::connection(s));
+        /*
+         * Lazy connections are created closed, so that a failed one
+         * still has an object to be reopened later.
+         */
+        emplace_back(new pqxx::lazyconnection(s));
+
+        states_.emplace_back(new state_type {});
+        states_.back()->backoff = min_backoff;
+    }
+
+    /*
+     * Open connections in parallel, startup takes as long as the slowest
+     * of them rather than all of them together.
+     */
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        threads.emplace_back([this, i]()
+        {
+            if (!open(i))
+                backoff(i);
+        });
+    }
+
+    for (auto& t: threads)
+    {
+        t.join();
     }
 }
 
+/*!
+ * Declare a prepared statement on every connection of the pool.
+ * \param name Statement name.
+ * \param definition Statement SQL with `$n` parameters.
+ */
+void
+pool::prepare(std::string const& name, std::string const& definition)
+{
+    for (auto& conn: *this)
+    {
+        conn->prepare(name, definition);
+    }
+}
+
+/*!
+ * Get a connection string of the connection.
+ * \param i Connection index.
+ * \return
+ */
+std::string const&
+pool::conn_str(std::size_t i) const
+{
+    return conn_str_[i];
+}
+
+/*!
+ * Get health of the connection.
+ * \param i Connection index.
+ * \return
+ */
+pool::health_type const&
+pool::health(std::size_t i) const
+{
+    return states_[i]->health;
+}
+
+/*!
+ * Mark the connection broken, it is reopened by `reconnect`.
+ * \param i Connection index.
+ */
+void
+pool::broken(std::size_t i)
+{
+    state_type& s = *states_[i];
+
+    if (!s.health.healthy)
+        return;
+
+    YS_LOG(warning) << "Database connection " << i << " is broken";
+
+    s.health.healthy = false;
+    ++s.health.failures;
+
+    /*
+     * The first attempt is made right away, a connection is often
+     * broken by a server restart which is over by now.
+     */
+    s.backoff = min_backoff;
+    s.retry_time = clock_type::now();
+}
+
+/*!
+ * Reopen the connection if it is broken and the backoff delay
+ * has passed.
+ * \param i Connection index.
+ * \return True if the connection is healthy.
+ */
+bool
+pool::reconnect(std::size_t i)
+{
+    state_type& s = *states_[i];
+
+    if (s.health.healthy)
+        return true;
+
+    if (clock_type::now() < s.retry_time)
+        return false;
+
+    (*this)[i]->disconnect();
+
+    if (!open(i))
+    {
+        backoff(i);
+        return false;
+    }
+
+    ++s.health.reconnects;
+
+    YS_LOG(info) << "Database connection " << i << " reopened";
+
+    return true;
+}
+
+/*!
+ * Open the connection.
+ * \param i Connection index.
+ * \return True on success.
+ */
+bool
+pool::open(std::size_t i)
+{
+    try
+    {
+        (*this)[i]->activate();
+    }
+    catch (std::exception const& e)
+    {
+        /*
+         * Connection strings may hold passwords, so only the index
+         * is logged.
+         */
+        YS_LOG(error) << "Failed to open database connection " << i <<
+                      ": " << e.what();
+
+        return false;
+    }
+
+    state_type& s = *states_[i];
+
+    s.health.healthy = true;
+    s.backoff = min_backoff;
+
+    return true;
+}
+
+/*!
+ * Schedule the next reconnection attempt.
+ * \param i Connection index.
+ */
+void
+pool::backoff(std::size_t i)
+{
+    state_type& s = *states_[i];
+
+    s.retry_time = clock_type::now() + s.backoff;
+    s.backoff = std::min(s.backoff * 2, max_backoff_);
+}
+
 } // namespace db
 } // namespace ys
-
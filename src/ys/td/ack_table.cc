@@ -0,0 +1,129 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Delivery tickets table source file.
+ */
+
+#include <ys/td/ack_table.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Open a ticket holding one reference, which the opener releases.
+ * \param handler Handler called when the ticket is done.
+ * \return Ticket, never 0.
+ */
+uint32_t
+ack_table::open(handler_type handler)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    /*
+     * Tickets wrap around, 0 means no ticket and open ones are skipped.
+     */
+    do
+    {
+        ++last_;
+    }
+    while (last_ == 0 || tickets_.count(last_));
+
+    tickets_.emplace(last_, entry { 1, clock_type::now(), handler });
+
+    return last_;
+}
+
+/*!
+ * Add references to the ticket.
+ * \param ticket
+ * \param n Number of references.
+ */
+void
+ack_table::retain(uint32_t ticket, std::size_t n)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    auto it = tickets_.find(ticket);
+
+    if (it != tickets_.end())
+        it->second.refs += n;
+}
+
+/*!
+ * Drop references to the ticket, the handler is called when
+ * the last one is dropped.
+ * \param ticket Ticket, 0 is ignored.
+ * \param n Number of references.
+ */
+void
+ack_table::release(uint32_t ticket, std::size_t n)
+{
+    if (ticket == 0 || n == 0)
+        return;
+
+    handler_type handler;
+    clock_type::time_point time;
+
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+
+        auto it = tickets_.find(ticket);
+
+        if (it == tickets_.end())
+            return;
+
+        if (it->second.refs > n)
+        {
+            it->second.refs -= n;
+            return;
+        }
+
+        handler.swap(it->second.handler);
+        time = it->second.time;
+
+        tickets_.erase(it);
+    }
+
+    uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                           clock_type::now() - time).count();
+
+    ++stats_.done;
+    stats_.latency += latency;
+
+    if (latency > stats_.max_latency)
+        stats_.max_latency = latency;
+
+    /*
+     * The handler is called without the lock, it may open a new ticket.
+     */
+    if (handler)
+        handler(ticket);
+}
+
+/*!
+ * Get a number of open tickets.
+ * \return
+ */
+std::size_t
+ack_table::size() const
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    return tickets_.size();
+}
+
+/*!
+ * Get tickets statistics.
+ * \return
+ */
+ack_table::stats_type const&
+ack_table::stats() const
+{
+    return stats_;
+}
+
+} // namespace td
+} // namespace ys
@@ -46,7 +46,9 @@ void
 config::init_cmd_options()
 {
     ys::config::init_cmd_options()
-    ("config", option<std::string>(), "Config file path");
+    ("config", option<std::string>(), "Config file path")
+    ("shard-dry-run", option<std::string>(),
+     "Print trackers moved by a new shards list from a config file");
 }
 
 /*!
@@ -69,6 +71,7 @@ config::read_cfg_options()
 void
 config::load_cmd_options()
 {
+    data.shard_dry_run = cmd_option<std::string>("shard-dry-run");
 }
 
 /*!
@@ -79,9 +82,30 @@ config::load_cfg_options()
 {
     load_cfg_option("workers", &data.w_count);
     load_cfg_option("host", &data.host);
-    load_cfg_string_list("db", &data.db);
+
+    load_shards(cfg_options(), data.shards);
+
+    for (auto& s: data.shards)
+    {
+        data.db.push_back(s.conn);
+    }
+
+    /*
+     * Lookup databases are optional.
+     */
+    if (auto lookup = cfg_options().get_child_optional("lookup_db"))
+    {
+        for (auto& d: *lookup)
+        {
+            data.lookup_db.push_back(d.second.data());
+        }
+    }
+
+    if (data.lookup_db.empty())
+        data.lookup_db.push_back(data.db.front());
 
     load_ports_cfg();
+    load_saver_cfg();
 }
 
 /*!
@@ -102,12 +126,104 @@ config::load_ports_cfg()
             {
                 port,
                 p.second.get<std::string>("parser"),
-                p.second.get<std::string>("typename")
+                p.second.get<std::string>("typename"),
+                p.second.get("ack_commit", false)
             }
         });
     }
 }
 
+/*!
+ * Load database shards from a config tree.
+ * \param tree Config tree with a `db` list.
+ * \param shards Output container.
+ */
+void
+config::load_shards(boost::property_tree::ptree const& tree,
+                    std::vector<db_shard>& shards)
+{
+    for (auto& d: tree.get_child("db"))
+    {
+        /*
+         * A shard is either a plain connection string or an object
+         * with a connection string, a name and a weight.
+         */
+        if (d.second.empty())
+        {
+            shards.push_back({ d.second.data(), d.second.data() });
+            continue;
+        }
+
+        db_shard s;
+
+        s.conn = d.second.get<std::string>("conn");
+        s.name = d.second.get("name", s.conn);
+        s.weight = d.second.get("weight", s.weight);
+
+        shards.push_back(s);
+    }
+}
+
+/*!
+ * Load saver configuration into variables.
+ */
+void
+config::load_saver_cfg()
+{
+    auto& s = data.saver;
+    auto& opts = cfg_options();
+
+    s.queue_size = opts.get("saver.queue_size", s.queue_size);
+    s.writer_queue_size = opts.get("saver.writer_queue_size",
+                                   s.writer_queue_size);
+    s.batch_size = opts.get("saver.batch_size", s.batch_size);
+    s.batch_wait = opts.get("saver.batch_wait", s.batch_wait);
+    s.stats_interval = opts.get("saver.stats_interval", s.stats_interval);
+    s.id_snapshot = opts.get("saver.id_snapshot", s.id_snapshot);
+    s.id_snapshot_interval = opts.get("saver.id_snapshot_interval",
+                                      s.id_snapshot_interval);
+    s.unknown_ttl = opts.get("saver.unknown_ttl", s.unknown_ttl);
+    s.insert_chunk = opts.get("saver.insert_chunk", s.insert_chunk);
+    s.spool = opts.get("saver.spool", s.spool);
+    s.spool_segment_size = opts.get("saver.spool_segment_size",
+                                    s.spool_segment_size);
+    s.spool_depth = opts.get("saver.spool_depth", s.spool_depth);
+    s.max_parked = opts.get("saver.max_parked", s.max_parked);
+    s.spool_latency = opts.get("saver.spool_latency", s.spool_latency);
+    s.push_batch = opts.get("saver.push_batch", s.push_batch);
+    s.reconnect_backoff = opts.get("saver.reconnect_backoff",
+                                   s.reconnect_backoff);
+    s.dedup_window = opts.get("saver.dedup_window", s.dedup_window);
+    s.state_table = opts.get("saver.state_table", s.state_table);
+    s.state_interval = opts.get("saver.state_interval", s.state_interval);
+    s.copy = opts.get("saver.copy", s.copy);
+    s.copy_merge = opts.get("saver.copy_merge", s.copy_merge);
+    s.live_age = opts.get("saver.live_age", s.live_age);
+    s.bulk_batch_size = opts.get("saver.bulk_batch_size", s.bulk_batch_size);
+    s.async = opts.get("saver.async", s.async);
+    s.ack_latency = opts.get("saver.ack_latency", s.ack_latency);
+    s.registry_interval = opts.get("saver.registry_interval",
+                                   s.registry_interval);
+
+    /*
+     * A batch must hold at least one report.
+     */
+    if (s.batch_size == 0)
+        s.batch_size = 1;
+
+    if (s.push_batch == 0)
+        s.push_batch = 1;
+
+    if (s.bulk_batch_size == 0)
+        s.bulk_batch_size = 1;
+
+    /*
+     * A spool segment must hold at least one report.
+     */
+    if (s.spool_segment_size == 0)
+        s.spool_segment_size = 1;
+}
+
 } // namespace td
 } // namespace ys
 
@@ -0,0 +1,328 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Binary COPY reports writer class source file.
+ */
+
+#include <ys/td/copier.h>
+
+#include <cstring>
+#include <endian.h>
+
+#include <pqxx/pqxx>
+
+#include <ys/td/error.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * COPY binary format signature.
+ */
+const char copy_signature[] = "PGCOPY\n\377\r\n";
+
+/*!
+ * Seconds between the Unix and the PostgreSQL epochs.
+ */
+const int64_t pg_epoch = 946684800;
+
+/*!
+ * Number of staging table columns.
+ */
+const int16_t staging_columns = 10;
+
+/*!
+ * Append a big-endian 16-bit value.
+ * \param buf
+ * \param v
+ */
+void
+put16(std::string& buf, uint16_t v)
+{
+    v = htobe16(v);
+    buf.append(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+/*!
+ * Append a big-endian 32-bit value.
+ * \param buf
+ * \param v
+ */
+void
+put32(std::string& buf, uint32_t v)
+{
+    v = htobe32(v);
+    buf.append(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+/*!
+ * Append a big-endian 64-bit value.
+ * \param buf
+ * \param v
+ */
+void
+put64(std::string& buf, uint64_t v)
+{
+    v = htobe64(v);
+    buf.append(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+/*!
+ * Append an `integer` field.
+ * \param buf
+ * \param v
+ */
+void
+put_int4(std::string& buf, int32_t v)
+{
+    put32(buf, sizeof(v));
+    put32(buf, v);
+}
+
+/*!
+ * Append a `bigint` or a `timestamp` field.
+ * \param buf
+ * \param v
+ */
+void
+put_int8(std::string& buf, int64_t v)
+{
+    put32(buf, sizeof(v));
+    put64(buf, v);
+}
+
+/*!
+ * Append a `double precision` field.
+ * \param buf
+ * \param v
+ */
+void
+put_float8(std::string& buf, double v)
+{
+    uint64_t bits;
+
+    std::memcpy(&bits, &v, sizeof(bits));
+
+    put32(buf, sizeof(bits));
+    put64(buf, bits);
+}
+
+} // namespace
+
+/*!
+ * Name of the staging table.
+ */
+const char* const copier::staging_table = "ys_td_staging";
+
+/*!
+ * Constructor, the connection is opened on the first use.
+ * \param conn_str Connection string.
+ * \param merge Statement merging the staging table into the log.
+ */
+copier::copier(std::string const& conn_str, std::string const& merge) :
+    conn_str_ { conn_str },
+    merge_ { merge }
+{
+}
+
+/*!
+ * Destructor.
+ */
+copier::~copier()
+{
+    if (conn_)
+        PQfinish(conn_);
+}
+
+/*!
+ * Save reports in a single transaction.
+ * \param first
+ * \param last
+ * \throw pqxx::broken_connection
+ * \throw error
+ */
+void
+copier::save(row_type const* first, row_type const* last)
+{
+    if (!conn_ || PQstatus(conn_) != CONNECTION_OK)
+        open();
+
+    buf_.clear();
+    encode(first, last, buf_);
+
+    exec("begin");
+
+    try
+    {
+        std::string copy = std::string { "copy " } + staging_table +
+                           " from stdin (format binary)";
+
+        if (exec(copy.c_str()) != PGRES_COPY_IN)
+            throw error("Unexpected COPY response");
+
+        if (PQputCopyData(conn_, buf_.data(), buf_.size()) != 1 ||
+            PQputCopyEnd(conn_, nullptr) != 1)
+            fail();
+
+        /*
+         * Collect the COPY result.
+         */
+        while (PGresult* r = PQgetResult(conn_))
+        {
+            ExecStatusType status = PQresultStatus(r);
+            std::string msg = PQresultErrorMessage(r);
+
+            PQclear(r);
+
+            if (status != PGRES_COMMAND_OK)
+                throw error("COPY failed: %s", msg.c_str());
+        }
+
+        exec(merge_.c_str());
+        exec("commit");
+    }
+    catch (...)
+    {
+        if (PQstatus(conn_) == CONNECTION_OK)
+            PQclear(PQexec(conn_, "rollback"));
+
+        throw;
+    }
+}
+
+/*!
+ * Encode reports as COPY binary format data.
+ * \param first
+ * \param last
+ * \param buf Output buffer.
+ */
+void
+copier::encode(row_type const* first, row_type const* last,
+               std::string& buf)
+{
+    /*
+     * Header: signature, flags and header extension length.
+     */
+    buf.append(copy_signature, sizeof(copy_signature));
+    put32(buf, 0);
+    put32(buf, 0);
+
+    /*
+     * Rows are numbered, so that the merge can keep their order.
+     */
+    int32_t n = 0;
+
+    for (auto row = first; row != last; ++row)
+    {
+        report const& d = row->second;
+
+        put16(buf, staging_columns);
+
+        put_int4(buf, n++);
+        put_int4(buf, row->first);
+        put_int8(buf, (d.datetime - pg_epoch) * 1000000);
+        put_float8(buf, d.lon / 1000000.0);
+        put_float8(buf, d.lat / 1000000.0);
+        put_int4(buf, d.speed);
+        put_int8(buf, d.odometer);
+        put_int4(buf, d.course);
+        put_int4(buf, d.sats_glonass);
+        put_int4(buf, d.sats_gps);
+    }
+
+    /*
+     * Trailer.
+     */
+    put16(buf, -1);
+}
+
+/*!
+ * Open the connection and create the staging table if required.
+ * \throw pqxx::broken_connection
+ * \throw error
+ */
+void
+copier::open()
+{
+    if (conn_)
+        PQreset(conn_);
+    else
+        conn_ = PQconnectdb(conn_str_.c_str());
+
+    if (PQstatus(conn_) != CONNECTION_OK)
+        fail();
+
+    /*
+     * A temporary table lives as long as the connection, it is created
+     * again after a reconnect.
+     */
+    std::string create = std::string { "create temp table if not exists " } +
+                         staging_table + " ("
+                         "n integer, "
+                         "id integer, "
+                         "datetime timestamp, "
+                         "lon double precision, "
+                         "lat double precision, "
+                         "speed integer, "
+                         "odometer bigint, "
+                         "course integer, "
+                         "sats_glonass integer, "
+                         "sats_gps integer"
+                         ") on commit delete rows";
+
+    exec(create.c_str());
+}
+
+/*!
+ * Execute a statement.
+ * \param sql
+ * \return Result status.
+ * \throw pqxx::broken_connection
+ * \throw error
+ */
+ExecStatusType
+copier::exec(char const* sql)
+{
+    PGresult* r = PQexec(conn_, sql);
+
+    if (!r)
+        fail();
+
+    ExecStatusType status = PQresultStatus(r);
+    std::string msg = PQresultErrorMessage(r);
+
+    PQclear(r);
+
+    if (PQstatus(conn_) != CONNECTION_OK)
+        fail();
+
+    if (status == PGRES_BAD_RESPONSE || status == PGRES_FATAL_ERROR)
+        throw error("%s", msg.c_str());
+
+    return status;
+}
+
+/*!
+ * Throw an exception describing the last connection error.
+ * \throw pqxx::broken_connection
+ * \throw error
+ */
+void
+copier::fail()
+{
+    std::string msg = conn_ ? PQerrorMessage(conn_) : "out of memory";
+
+    if (!conn_ || PQstatus(conn_) != CONNECTION_OK)
+        throw pqxx::broken_connection(msg);
+
+    throw error("%s", msg.c_str());
+}
+
+} // namespace td
+} // namespace ys
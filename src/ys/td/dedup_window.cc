@@ -0,0 +1,112 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Duplicate reports filter source file.
+ */
+
+#include <ys/td/dedup_window.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Constructor.
+ * \param size Number of reports remembered per tracker, 0 disables
+ *             the filter.
+ */
+dedup_window::dedup_window(std::size_t size) :
+    size_ { size }
+{
+}
+
+/*!
+ * Check whether the report was saved recently.
+ * \param id Tracker id.
+ * \param d
+ * \return True if the report is a duplicate.
+ */
+bool
+dedup_window::seen(uint32_t id, report const& d)
+{
+    if (size_ == 0)
+        return false;
+
+    stripe& s = stripes_[id % stripes];
+
+    std::lock_guard<std::mutex> lock { s.mutex };
+
+    auto it = s.index.find(id);
+
+    if (it == s.index.end())
+        return false;
+
+    fingerprint const* p = &s.prints[it->second * size_];
+
+    for (std::size_t i = 0; i < size_; ++i)
+    {
+        if (p[i].datetime == d.datetime && p[i].lon == d.lon &&
+            p[i].lat == d.lat)
+            return true;
+    }
+
+    return false;
+}
+
+/*!
+ * Remember a saved report, replacing the oldest one of the tracker.
+ * \param id Tracker id.
+ * \param d
+ */
+void
+dedup_window::add(uint32_t id, report const& d)
+{
+    if (size_ == 0)
+        return;
+
+    stripe& s = stripes_[id % stripes];
+
+    std::lock_guard<std::mutex> lock { s.mutex };
+
+    auto ins = s.index.emplace(id, s.next.size());
+
+    std::size_t w = ins.first->second;
+
+    if (ins.second)
+    {
+        /*
+         * A new tracker gets a window of empty fingerprints, no report
+         * has a zero time.
+         */
+        s.prints.resize(s.prints.size() + size_, fingerprint {});
+        s.next.push_back(0);
+    }
+
+    uint32_t& n = s.next[w];
+
+    s.prints[w * size_ + n] = { d.datetime, d.lon, d.lat };
+    n = (n + 1) % size_;
+}
+
+/*!
+ * Get a number of trackers remembered.
+ * \return
+ */
+std::size_t
+dedup_window::trackers() const
+{
+    std::size_t n = 0;
+
+    for (auto& s: stripes_)
+    {
+        std::lock_guard<std::mutex> lock { s.mutex };
+        n += s.index.size();
+    }
+
+    return n;
+}
+
+} // namespace td
+} // namespace ys
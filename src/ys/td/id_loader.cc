@@ -0,0 +1,274 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids bulk loader class source file.
+ */
+
+#include <ys/td/id_loader.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <ys/logger.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * First line of a snapshot file, it changes with the format of lines.
+ */
+const std::string snapshot_header = "ys-td tracker ids 2";
+
+} // namespace
+
+/*!
+ * Constructor.
+ * \param conn_str Connection string of a database to load ids from.
+ * \param path Snapshot file path.
+ * \param interval Interval in seconds between reloads.
+ */
+id_loader::id_loader(std::string const& conn_str, std::string const& path,
+                     int interval) :
+    conn_str_ { conn_str },
+    path_ { path },
+    interval_ { interval }
+{
+}
+
+/*!
+ * Load all tracker ids with one query.
+ * \param conn Database connection.
+ * \param cache Output container.
+ */
+void
+id_loader::load(pqxx::connection_base& conn, cache_type& cache)
+{
+    pqxx::work tx { conn };
+
+    auto rows = tx.exec("select t.id, t.num, t.sim, t.sim2, y.name "
+                        "from trackers.trackers t "
+                        "join trackers.types y on y.id = t.typeid "
+                        "order by t.id");
+
+    for (auto row: rows)
+    {
+        uint32_t id = row["id"].as<uint32_t>();
+        std::string type = row["name"].as<std::string>();
+
+        /*
+         * A tracker may be reported by its number or by any of its sim
+         * numbers.
+         */
+        for (char const* f: { "num", "sim", "sim2" })
+        {
+            std::string v = row[f].as<std::string>(std::string {});
+
+            if (!v.empty())
+                cache.push_back({ id, f[0] == 's', type, v });
+        }
+    }
+}
+
+/*!
+ * Read tracker ids from the snapshot file.
+ * \param cache Output container.
+ * \return False if there is no readable snapshot.
+ */
+bool
+id_loader::read(cache_type& cache) const
+{
+    std::ifstream is { path_ };
+
+    if (!is)
+        return false;
+
+    std::string line;
+
+    /*
+     * A snapshot of another format is ignored, ids are loaded from
+     * a database then.
+     */
+    if (!std::getline(is, line) || line != snapshot_header)
+    {
+        YS_LOG(warning) << "Tracker ids snapshot " << path_ <<
+                        " has an unknown format";
+        return false;
+    }
+
+    std::size_t size = cache.size();
+
+    /*
+     * Every line is `<id>\t<n|s>\t<type>\t<number>`, type names may
+     * have spaces.
+     */
+    while (std::getline(is, line))
+    {
+        std::size_t kind = line.find('\t');
+        std::size_t type = line.find('\t', kind + 1);
+        std::size_t number = line.find('\t', type + 1);
+
+        bool valid = kind > 0 && kind <= 10 && number != line.npos &&
+                     line.find_first_not_of("0123456789") == kind &&
+                     type == kind + 2 &&
+                     (line[kind + 1] == 'n' || line[kind + 1] == 's');
+
+        unsigned long id = valid ? std::stoul(line.substr(0, kind)) : 0;
+
+        if (!valid || id > UINT32_MAX)
+        {
+            YS_LOG(warning) << "Tracker ids snapshot " << path_ <<
+                            " is corrupt";
+
+            cache.resize(size);
+            return false;
+        }
+
+        entry e;
+
+        e.id = id;
+        e.sim = line[kind + 1] == 's';
+        e.type = line.substr(type + 1, number - type - 1);
+        e.number = line.substr(number + 1);
+
+        cache.push_back(e);
+    }
+
+    return true;
+}
+
+/*!
+ * Write tracker ids to the snapshot file.
+ * \param cache
+ */
+void
+id_loader::write(cache_type const& cache) const
+{
+    /*
+     * Write a temporary file and rename it so that a reader never sees
+     * a partially written snapshot, the data is flushed to the disk
+     * first so that a power loss does not leave an empty file behind
+     * the new name.
+     */
+
+    std::string tmp = path_ + ".tmp";
+
+    std::FILE* f = std::fopen(tmp.c_str(), "w");
+
+    if (!f)
+    {
+        YS_LOG(error) << "Failed to open tracker ids snapshot " << tmp;
+        return;
+    }
+
+    bool ok = std::fprintf(f, "%s\n", snapshot_header.c_str()) > 0;
+
+    for (auto& e: cache)
+    {
+        ok = ok && std::fprintf(f, "%u\t%c\t%s\t%s\n", e.id,
+                                e.sim ? 's' : 'n', e.type.c_str(),
+                                e.number.c_str()) > 0;
+    }
+
+    ok = std::fflush(f) == 0 && ::fsync(fileno(f)) == 0 && ok;
+    ok = std::fclose(f) == 0 && ok;
+
+    if (!ok)
+    {
+        YS_LOG(error) << "Failed to write tracker ids snapshot " << tmp;
+        return;
+    }
+
+    if (std::rename(tmp.c_str(), path_.c_str()) != 0)
+        YS_LOG(error) << "Failed to rename tracker ids snapshot " << tmp;
+}
+
+/*!
+ * Start the periodic reload process.
+ *
+ * The first reload happens after the interval, the caller is expected to
+ * have the ids loaded by that time.
+ */
+void
+id_loader::run()
+{
+    std::unique_lock<std::mutex> lock { mutex_ };
+
+    /*!
+     * Interruption condition.
+     */
+    auto interrupted = [this]()
+    {
+        return interrupted_;
+    };
+
+    while (!cond_.wait_for(lock, std::chrono::seconds { interval_ },
+                           interrupted))
+    {
+        lock.unlock();
+
+        try
+        {
+            pqxx::connection conn { conn_str_ };
+            std::unique_ptr<cache_type> cache { new cache_type {} };
+
+            load(conn, *cache);
+            write(*cache);
+
+            YS_LOG(info) << "Reloaded " << cache->size() << " tracker ids";
+
+            lock.lock();
+            fresh_ = std::move(cache);
+        }
+        catch (std::exception const& e)
+        {
+            YS_LOG(error) << "Failed to reload tracker ids: " << e.what();
+
+            lock.lock();
+        }
+    }
+}
+
+/*!
+ * Interrupt execution.
+ */
+void
+id_loader::interrupt()
+{
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+        interrupted_ = true;
+    }
+
+    cond_.notify_all();
+}
+
+/*!
+ * Take freshly reloaded ids if there are any.
+ * \param cache Container to swap fresh ids into.
+ * \return True if fresh ids were taken.
+ */
+bool
+id_loader::take(cache_type& cache)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if (!fresh_)
+        return false;
+
+    cache.swap(*fresh_);
+    fresh_.reset();
+
+    return true;
+}
+
+} // namespace td
+} // namespace ys
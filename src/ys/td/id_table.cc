@@ -0,0 +1,236 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids hash table source file.
+ */
+
+#include <ys/td/id_table.h>
+
+#include <cstring>
+#include <utility>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Constructor.
+ * \param capacity Expected number of entries.
+ */
+id_table::id_table(std::size_t capacity)
+{
+    /*
+     * Keep the load factor under a half.
+     */
+
+    std::size_t n = 16;
+
+    while (n < capacity * 2)
+        n *= 2;
+
+    slots_.resize(n);
+}
+
+/*!
+ * Check whether the key can be kept in the table.
+ * \param k
+ * \return
+ */
+bool
+id_table::fits(key_type const& k)
+{
+    return k.size <= max_number;
+}
+
+/*!
+ * Find a value by key.
+ * \param k
+ * \return Null if there is no such key.
+ */
+id_table::value_type*
+id_table::find(key_type const& k)
+{
+    if (!fits(k))
+        return nullptr;
+
+    slot& s = probe(hash(k), k);
+
+    return s.hash ? &s.value : nullptr;
+}
+
+/*!
+ * Find a value by key.
+ * \param k
+ * \return Null if there is no such key.
+ */
+id_table::value_type const*
+id_table::find(key_type const& k) const
+{
+    /*
+     * Probing does not change the table.
+     */
+    return const_cast<id_table*>(this)->find(k);
+}
+
+/*!
+ * Find a value by key, add a zeroed one if there is no such key.
+ * \param k
+ * \return Null if the key does not fit the table.
+ */
+id_table::value_type*
+id_table::insert(key_type const& k)
+{
+    if (!fits(k))
+        return nullptr;
+
+    uint64_t h = hash(k);
+
+    slot* s = &probe(h, k);
+
+    if (s->hash)
+        return &s->value;
+
+    if ((size_ + 1) * 2 > slots_.size())
+    {
+        grow();
+        s = &probe(h, k);
+    }
+
+    s->hash = h;
+    std::memcpy(s->number, k.number, k.size);
+    s->size = k.size;
+    s->type = k.type;
+    s->sim = k.sim;
+    s->value = {};
+
+    ++size_;
+
+    return &s->value;
+}
+
+/*!
+ * Get a number of entries.
+ * \return
+ */
+std::size_t
+id_table::size() const
+{
+    return size_;
+}
+
+/*!
+ * Swap contents with another table.
+ * \param t
+ */
+void
+id_table::swap(id_table& t)
+{
+    slots_.swap(t.slots_);
+    std::swap(size_, t.size_);
+}
+
+/*!
+ * Compute a key hash, never 0.
+ * \param k
+ * \return
+ */
+uint64_t
+id_table::hash(key_type const& k)
+{
+    /*
+     * FNV-1a over the number, then mix in the type and the sim flag.
+     */
+
+    uint64_t h = 14695981039346656037ull;
+
+    for (std::size_t i = 0; i < k.size; ++i)
+    {
+        h ^= static_cast<uint8_t>(k.number[i]);
+        h *= 1099511628211ull;
+    }
+
+    h ^= (static_cast<uint64_t>(k.type) << 1) | k.sim;
+    h *= 1099511628211ull;
+
+    /*
+     * Spread the low bits used for the slot index.
+     */
+    h ^= h >> 29;
+
+    return h ? h : 1;
+}
+
+/*!
+ * Check whether the slot holds the key.
+ * \param s
+ * \param h Key hash.
+ * \param k
+ * \return
+ */
+bool
+id_table::match(slot const& s, uint64_t h, key_type const& k)
+{
+    return s.hash == h && s.size == k.size && s.type == k.type &&
+           s.sim == k.sim && std::memcmp(s.number, k.number, k.size) == 0;
+}
+
+/*!
+ * Find a slot holding the key or an empty slot to put it into.
+ * \param h Key hash.
+ * \param k
+ * \return
+ */
+id_table::slot&
+id_table::probe(uint64_t h, key_type const& k)
+{
+    std::size_t mask = slots_.size() - 1;
+
+    for (std::size_t i = h & mask;; i = (i + 1) & mask)
+    {
+        slot& s = slots_[i];
+
+        if (!s.hash || match(s, h, k))
+            return s;
+    }
+}
+
+/*!
+ * Put an occupied slot into the table known not to contain its key.
+ * \param s
+ */
+void
+id_table::place(slot const& s)
+{
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = s.hash & mask;
+
+    while (slots_[i].hash)
+        i = (i + 1) & mask;
+
+    slots_[i] = s;
+
+    ++size_;
+}
+
+/*!
+ * Double the number of slots.
+ */
+void
+id_table::grow()
+{
+    std::vector<slot> slots(slots_.size() * 2);
+
+    slots.swap(slots_);
+    size_ = 0;
+
+    for (auto& s: slots)
+    {
+        if (s.hash)
+            place(s);
+    }
+}
+
+} // namespace td
+} // namespace ys
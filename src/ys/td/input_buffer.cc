@@ -0,0 +1,196 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Parser input buffer source file.
+ */
+
+#include <ys/td/input_buffer.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Drop `n` bytes from the front, all of them if there are fewer.
+ * \param n
+ */
+void
+input_buffer::consume(std::size_t n)
+{
+    n = std::min(n, size());
+
+    if (borrowed_)
+    {
+        borrowed_ += n;
+        borrowed_size_ -= n;
+        return;
+    }
+
+    offset_ += n;
+
+    /*
+     * A fully parsed buffer is reset for free, which is the usual case
+     * when a read holds whole messages.
+     */
+    if (offset_ == data_.size())
+        clear();
+}
+
+/*!
+ * Drop bytes in the range `[begin(), it)`.
+ * \param it
+ */
+void
+input_buffer::consume(const_iterator it)
+{
+    consume(std::distance(begin(), it));
+}
+
+/*!
+ * Add bytes to the buffer without copying them if it is empty.
+ * \param p
+ * \param n
+ */
+void
+input_buffer::borrow(value_type const* p, std::size_t n)
+{
+    /*
+     * A message split between reads is completed in the own storage.
+     */
+    if (!empty())
+    {
+        append(p, p + n);
+        return;
+    }
+
+    clear();
+
+    borrowed_ = p;
+    borrowed_size_ = n;
+}
+
+/*!
+ * Copy borrowed bytes not consumed yet into the buffer.
+ */
+void
+input_buffer::detach()
+{
+    if (!borrowed_)
+        return;
+
+    /*
+     * Usually nothing or a part of the last message is left.
+     */
+    data_.assign(borrowed_, borrowed_ + borrowed_size_);
+    offset_ = 0;
+
+    borrowed_ = nullptr;
+    borrowed_size_ = 0;
+}
+
+/*!
+ * Drop all bytes.
+ */
+void
+input_buffer::clear()
+{
+    data_.clear();
+    offset_ = 0;
+
+    borrowed_ = nullptr;
+    borrowed_size_ = 0;
+}
+
+/*!
+ * Get an iterator to the first unread byte.
+ * \return
+ */
+input_buffer::const_iterator
+input_buffer::begin() const
+{
+    return data();
+}
+
+/*!
+ * Get an iterator past the last byte.
+ * \return
+ */
+input_buffer::const_iterator
+input_buffer::end() const
+{
+    return data() + size();
+}
+
+/*!
+ * Get a pointer to the first unread byte.
+ * \return
+ */
+input_buffer::value_type const*
+input_buffer::data() const
+{
+    return borrowed_ ? borrowed_ : data_.data() + offset_;
+}
+
+/*!
+ * Get an unread byte.
+ * \param i Index from the first unread byte.
+ * \return
+ */
+input_buffer::value_type
+input_buffer::operator[](std::size_t i) const
+{
+    return data()[i];
+}
+
+/*!
+ * Get a number of unread bytes.
+ * \return
+ */
+std::size_t
+input_buffer::size() const
+{
+    return borrowed_ ? borrowed_size_ : data_.size() - offset_;
+}
+
+/*!
+ * Check whether there are no unread bytes.
+ * \return
+ */
+bool
+input_buffer::empty() const
+{
+    return size() == 0;
+}
+
+/*!
+ * Move unread bytes to the front if it is worth it before appending.
+ * \param n Number of bytes to append.
+ */
+void
+input_buffer::compact(std::size_t n)
+{
+    if (offset_ == 0)
+        return;
+
+    /*
+     * The consumed part is reused when the bytes would not fit otherwise
+     * or when it outgrows the unread part, moving at most as many bytes
+     * as were consumed since the previous move.
+     */
+    std::size_t unread = size();
+
+    if (data_.size() + n <= data_.capacity() && offset_ < unread)
+        return;
+
+    std::memmove(data_.data(), data_.data() + offset_, unread);
+    data_.resize(unread);
+    offset_ = 0;
+}
+
+} // namespace td
+} // namespace ys
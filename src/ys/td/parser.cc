@@ -42,14 +42,24 @@ parser::data() const
 void
 parser::type(std::string const& name)
 {
-    data_.type = name;
+    data_.type = type_registry::intern(name);
+}
+
+/*!
+ * Copy loaded data not parsed yet from the external buffer before
+ * it is reused.
+ */
+void
+parser::detach()
+{
+    buffer_.detach();
 }
 
 /*!
  * Get a reference to a parser buffer.
  * \return
  */
-parser::buffer_type const&
+parser::input_type const&
 parser::buffer() const
 {
     return buffer_;
@@ -72,16 +82,11 @@ parser::response()
 void
 parser::consume(std::size_t n)
 {
-    if (n > buffer_.size())
-    {
-        buffer_.clear();
-    }
-    else
-    {
-        auto it = buffer_.begin();
-
-        buffer_.erase(it, std::next(it, n));
-    }
+    /*
+     * Only the read offset moves, parsing a burst of messages does not
+     * shift the rest of the burst after each of them.
+     */
+    buffer_.consume(n);
 }
 
 /*!
@@ -89,9 +94,9 @@ parser::consume(std::size_t n)
  * \param it
  */
 void
-parser::consume(buffer_type::iterator it)
+parser::consume(input_type::const_iterator it)
 {
-    buffer_.erase(buffer_.begin(), it);
+    buffer_.consume(it);
 }
 
 /*!
@@ -0,0 +1,83 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Compact tracker report source file.
+ */
+
+#include <ys/td/report.h>
+
+#include <mutex>
+#include <vector>
+
+#include <ys/td/error.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Registered type names, indexed by type id.
+ */
+std::vector<std::string> type_names { "" };
+
+/*!
+ * Type names access mutex.
+ */
+std::mutex type_names_mutex;
+
+} // namespace
+
+/*!
+ * Maximum length of a tracker number.
+ */
+const std::size_t report::max_number;
+
+/*!
+ * Get an id of the type name, registering it if required.
+ * \param name
+ * \return
+ * \throw error
+ */
+uint16_t
+type_registry::intern(std::string const& name)
+{
+    std::lock_guard<std::mutex> lock { type_names_mutex };
+
+    /*
+     * There are only a few types, a linear search is the fastest here.
+     */
+
+    for (std::size_t i = 0; i < type_names.size(); ++i)
+    {
+        if (type_names[i] == name)
+            return i;
+    }
+
+    if (type_names.size() > UINT16_MAX)
+        throw error("Too many tracker types");
+
+    type_names.push_back(name);
+
+    return type_names.size() - 1;
+}
+
+/*!
+ * Get a type name by its id.
+ * \param id
+ * \return Empty string for an unknown id.
+ */
+std::string
+type_registry::name(uint16_t id)
+{
+    std::lock_guard<std::mutex> lock { type_names_mutex };
+
+    return id < type_names.size() ? type_names[id] : std::string {};
+}
+
+} // namespace td
+} // namespace ys
@@ -0,0 +1,357 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids batch resolver class source file.
+ */
+
+#include <ys/td/resolver.h>
+
+#include <algorithm>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+#include <ys/logger.h>
+#include <ys/td/report.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Get a text array literal of the request numbers.
+ * \param first
+ * \param last
+ * \return
+ */
+template<typename Iterator>
+std::string
+numbers_array(Iterator first, Iterator last)
+{
+    std::string a { "{" };
+
+    for (auto it = first; it != last; ++it)
+    {
+        if (it != first)
+            a += ',';
+
+        a += '"';
+
+        for (char c: it->number)
+        {
+            if (c == '"' || c == '\\')
+                a += '\\';
+
+            a += c;
+        }
+
+        a += '"';
+    }
+
+    a += '}';
+
+    return a;
+}
+
+} // namespace
+
+/*!
+ * Constructor.
+ * \param conn_str Connection strings of databases to look ids up in.
+ * \param max_backoff Maximum delay between reconnection attempts.
+ */
+resolver::resolver(std::vector<std::string> const& conn_str,
+                   std::chrono::milliseconds max_backoff) :
+    db_ { conn_str, max_backoff }
+{
+    /*
+     * Ids are ordered, the lowest one wins when sim numbers are shared.
+     */
+
+    db_.prepare("tracker_ids_by_num",
+                "select t.id, s.number "
+                "from unnest($1::text[]) s (number) "
+                "join trackers.trackers t on t.num = s.number "
+                "where t.typeid = "
+                "(select id from trackers.types where name = $2) "
+                "order by t.id");
+
+    db_.prepare("tracker_ids_by_sim",
+                "select t.id, s.number "
+                "from unnest($1::text[]) s (number) "
+                "join trackers.trackers t on s.number in (t.sim, t.sim2) "
+                "where t.typeid = "
+                "(select id from trackers.types where name = $2) "
+                "order by t.id");
+}
+
+/*!
+ * Start the resolving process, one thread per lookup connection.
+ */
+void
+resolver::run()
+{
+    /*!
+     * Threads of connections but the first one.
+     */
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 1; i < db_.size(); ++i)
+    {
+        threads.emplace_back([this, i]()
+        {
+            work(i);
+        });
+    }
+
+    work(0);
+
+    for (auto& t: threads)
+    {
+        t.join();
+    }
+}
+
+/*!
+ * Interrupt execution.
+ */
+void
+resolver::interrupt()
+{
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+        interrupted_ = true;
+    }
+
+    cond_.notify_all();
+}
+
+/*!
+ * Add a request to the next batch.
+ * \param r
+ */
+void
+resolver::push(request const& r)
+{
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+        requests_.push_back(r);
+    }
+
+    cond_.notify_one();
+}
+
+/*!
+ * Take resolved requests if there are any.
+ * \param out Output vector, requests are appended to it.
+ * \return True if any requests were taken.
+ */
+bool
+resolver::take(std::vector<request>& out)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if (resolved_.empty())
+        return false;
+
+    out.insert(out.end(), resolved_.begin(), resolved_.end());
+    resolved_.clear();
+
+    return true;
+}
+
+/*!
+ * Get a number of executed queries.
+ * \return
+ */
+uint64_t
+resolver::queries() const
+{
+    return queries_;
+}
+
+/*!
+ * Get lookup connections.
+ * \return
+ */
+ys::db::pool const&
+resolver::db() const
+{
+    return db_;
+}
+
+/*!
+ * Resolve batches on a lookup connection.
+ * \param i Connection index.
+ */
+void
+resolver::work(std::size_t i)
+{
+    /*!
+     * Requests being resolved.
+     */
+    std::vector<request> batch;
+
+    std::unique_lock<std::mutex> lock { mutex_ };
+
+    for (;;)
+    {
+        cond_.wait(lock, [this]()
+        {
+            return interrupted_ || !requests_.empty();
+        });
+
+        if (interrupted_)
+            break;
+
+        lock.unlock();
+
+        bool up = db_.reconnect(i);
+
+        lock.lock();
+
+        /*
+         * A broken connection leaves requests to the healthy ones.
+         */
+        if (!up)
+        {
+            cond_.wait_for(lock, std::chrono::milliseconds { 100 }, [this]()
+            {
+                return interrupted_;
+            });
+
+            continue;
+        }
+
+        /*
+         * Another connection may have taken the requests meanwhile.
+         */
+        if (requests_.empty())
+            continue;
+
+        /*
+         * Requests arriving meanwhile make up the next batch,
+         * which an idle connection takes up.
+         */
+        batch.swap(requests_);
+
+        lock.unlock();
+
+        bool ok = resolve(i, batch);
+
+        lock.lock();
+
+        if (ok)
+        {
+            resolved_.insert(resolved_.end(), batch.begin(), batch.end());
+        }
+        else
+        {
+            /*
+             * The batch is retried together with newer requests, on another
+             * connection if there is one, after a pause so that a failing
+             * query is not repeated in a loop.
+             */
+            requests_.insert(requests_.end(), batch.begin(), batch.end());
+            cond_.notify_one();
+
+            cond_.wait_for(lock, std::chrono::seconds { 1 }, [this]()
+            {
+                return interrupted_;
+            });
+        }
+
+        batch.clear();
+    }
+}
+
+/*!
+ * Resolve a batch of requests.
+ * \param i Connection index.
+ * \param batch
+ * \return False if the batch failed and is to be retried.
+ */
+bool
+resolver::resolve(std::size_t i, std::vector<request>& batch)
+{
+    /*
+     * Group requests by tracker type and number kind, one query
+     * resolves a group.
+     */
+    std::sort(batch.begin(), batch.end(),
+              [](request const& a, request const& b)
+    {
+        return std::tie(a.type, a.sim) < std::tie(b.type, b.sim);
+    });
+
+    try
+    {
+        pqxx::work tx { *db_[i] };
+
+        for (auto first = batch.begin(); first != batch.end(); )
+        {
+            auto last = std::find_if(first, batch.end(),
+                                     [first](request const& r)
+            {
+                return r.type != first->type || r.sim != first->sim;
+            });
+
+            auto rows = tx.prepared(first->sim ? "tracker_ids_by_sim"
+                                               : "tracker_ids_by_num")
+                                   (numbers_array(first, last))
+                                   (type_registry::name(first->type))
+                                   .exec();
+
+            ++queries_;
+
+            /*!
+             * Found ids by numbers.
+             */
+            std::unordered_map<std::string, uint32_t> ids;
+
+            for (auto row: rows)
+            {
+                ids.emplace(row[1].as<std::string>(), row[0].as<uint32_t>());
+            }
+
+            for (; first != last; ++first)
+            {
+                auto it = ids.find(first->number);
+
+                first->id = it == ids.end() ? 0 : it->second;
+            }
+        }
+
+        tx.commit();
+    }
+    catch (pqxx::broken_connection const& e)
+    {
+        YS_LOG(error) << "Resolver connection " << i << " is broken: " <<
+                      e.what();
+
+        db_.broken(i);
+
+        return false;
+    }
+    catch (std::exception const& e)
+    {
+        /*
+         * Reports of the trackers stay parked meanwhile, taking the trackers
+         * as unknown would drop the reports of known ones.
+         */
+        YS_LOG(error) << "Failed to resolve " << batch.size() <<
+                      " tracker ids: " << e.what();
+
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace td
+} // namespace ys
@@ -7,181 +7,1380 @@
 
 #include <ys/td/saver.h>
 
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <iterator>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include <ys/logger.h>
+#include <ys/td/error.h>
+
 namespace ys
 {
-namespace td
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Cached id of a tracker being resolved.
+ */
+const uint32_t pending_id = UINT32_MAX;
+
+/*!
+ * Number of batches taken from the live queue while there is backlog
+ * before a backlog one is taken regardless.
+ */
+const unsigned bulk_interval = 8;
+
+/*!
+ * Minimum interval between purges of unknown trackers, every purge
+ * rebuilds the tracker ids cache.
+ */
+const std::chrono::seconds min_purge_interval { 60 };
+
+/*!
+ * Get a key of parked reports of a tracker.
+ * \param number Tracker number.
+ * \param size Number size.
+ * \param type Tracker type id.
+ * \param sim The number is a sim number.
+ * \return
+ */
+std::string
+parking_key(char const* number, std::size_t size, uint16_t type, bool sim)
+{
+    std::string key(number, size);
+
+    key.push_back(static_cast<char>(type >> 8));
+    key.push_back(static_cast<char>(type & 0xff));
+    key.push_back(sim);
+
+    return key;
+}
+
+/*!
+ * Threads stopped and joined at the latest when leaving a scope, so that
+ * an exception does not destroy a joinable thread and terminate.
+ */
+class thread_group
+{
+public:
+    /*!
+     * Constructor.
+     * \param stop Function asking the threads to stop.
+     */
+    explicit thread_group(std::function<void()> stop) :
+        stop_ { stop }
+    {
+    }
+
+    /*!
+     * Destructor.
+     */
+    ~thread_group()
+    {
+        join();
+    }
+
+    /*!
+     * Start a thread.
+     * \param fn Thread function.
+     */
+    template<typename Fn>
+    void
+    start(Fn fn)
+    {
+        threads_.emplace_back(fn);
+    }
+
+    /*!
+     * Ask the threads to stop and wait for them.
+     */
+    void
+    join()
+    {
+        if (threads_.empty())
+            return;
+
+        stop_();
+
+        for (auto& t: threads_)
+        {
+            t.join();
+        }
+
+        threads_.clear();
+    }
+
+private:
+    /*!
+     * Function asking the threads to stop.
+     */
+    std::function<void()> stop_;
+
+    /*!
+     * Threads.
+     */
+    std::vector<std::thread> threads_;
+};
+
+} // namespace
+
+/*!
+ * Constructor.
+ * \param db Database connections of writers, empty in the asynchronous
+ *           mode.
+ * \param states_db Database connection for trackers states.
+ * \param lookup_db Connection strings of databases to look tracker
+ *                  ids up in, the first one loads all ids at start.
+ * \param shards Database shards, in the order of `db` connections,
+ *                a writer is created for each.
+ * \param workers Number of workers, each of them reads tracker ids
+ *                from the registry.
+ * \param opts Saver settings.
+ * \throw error
+ */
+saver::saver(ys::db::pool& db, ys::db::pool& states_db,
+             std::vector<std::string> const& lookup_db,
+             std::vector<config::db_shard> const& shards,
+             std::size_t workers, config::saver_options const& opts) :
+    states_db_ { states_db },
+    ids_db_ { lookup_db.front() },
+    opts_ { opts },
+    ring_ { shards },
+    queue_ { opts.queue_size },
+    bulk_ { opts.queue_size },
+    registry_ { workers },
+    publish_time_ { clock_type::now() },
+    dedup_ { opts.dedup_window },
+    purge_time_ { clock_type::now() },
+    flush_time_ { clock_type::now() },
+    stats_time_ { clock_type::now() }
+{
+    /*
+     * Declare statements once per connection, they are planned by a server
+     * on the first use and executed with bound parameters after that.
+     * Writers of the asynchronous mode prepare them on connections
+     * of their own.
+     */
+
+    if (!opts_.async)
+        writer::prepare(db);
+
+    if (!opts_.state_table.empty())
+    {
+        /*
+         * States come as arrays unnested into rows. A position older
+         * than the stored one does not replace it, keep-alives come
+         * without a position and update the last seen time only.
+         */
+
+        std::string update;
+
+        for (auto col: { "datetime", "lon", "lat", "speed", "course" })
+        {
+            update += std::string { col } + " = case when "
+                      "excluded.datetime >= t.datetime or "
+                      "t.datetime is null "
+                      "then excluded." + col + " else t." + col + " end, ";
+        }
+
+        states_db_.prepare("state_upsert",
+                           "insert into " + opts_.state_table + " as t "
+                           "(id, datetime, lon, lat, speed, course, last_seen) "
+                           "select id, to_timestamp(dt) at time zone 'UTC', "
+                           "lon / 1000000.0, lat / 1000000.0, speed, course, "
+                           "to_timestamp(seen) at time zone 'UTC' "
+                           "from unnest($1::integer[], $2::bigint[], "
+                           "$3::integer[], $4::integer[], $5::integer[], "
+                           "$6::integer[], $7::bigint[]) "
+                           "as s (id, dt, lon, lat, speed, course, seen) "
+                           "on conflict (id) do update set " + update +
+                           "last_seen = "
+                           "greatest(excluded.last_seen, t.last_seen)");
+    }
+
+    /*
+     * Tracker ids are read from the lookup databases only, away from
+     * the write shards.
+     */
+    resolver_.reset(new resolver(lookup_db,
+                                 std::chrono::milliseconds {
+                                     opts_.reconnect_backoff }));
+
+    if (!opts_.id_snapshot.empty())
+    {
+        loader_.reset(new id_loader(lookup_db.front(), opts_.id_snapshot,
+                                    opts_.id_snapshot_interval));
+    }
+
+    if (!opts_.spool.empty())
+    {
+        spool_.reset(new spool(opts_.spool,
+                               opts_.spool_segment_size * 1024 * 1024));
+
+        YS_LOG(info) << "Spool " << opts_.spool << " holds " <<
+                     spool_->size() << " reports";
+    }
+
+    if (!opts_.async && ring_.size() != db.size())
+        throw error("%zu shards for %zu database connections",
+                    ring_.size(), db.size());
+
+    writers_.reserve(shards.size());
+
+    for (std::size_t i = 0; i < shards.size(); ++i)
+    {
+        writers_.emplace_back(new writer(db, i, shards[i].conn, opts_, acks_,
+                                         spool_.get(), dedup_));
+    }
+}
+
+/*!
+ * Start the saver process.
+ */
+void
+saver::run()
+{
+    warm_up();
+    publish_ids(true);
+
+    /*!
+     * Thread resolving tracker ids missing in the cache.
+     */
+    thread_group resolver_thread { [this]()
+    {
+        resolver_->interrupt();
+    } };
+
+    /*!
+     * Thread reloading tracker ids in the background.
+     */
+    thread_group loader_thread { [this]()
+    {
+        loader_->interrupt();
+    } };
+
+    resolver_thread.start([this]()
+    {
+        resolver_->run();
+    });
+
+    if (loader_)
+    {
+        loader_thread.start([this]()
+        {
+            loader_->run();
+        });
+    }
+
+    /*!
+     * Event loop of writers in the asynchronous mode.
+     */
+    boost::asio::io_service io;
+
+    /*!
+     * Keeps the event loop running while writers are idle.
+     */
+    std::unique_ptr<boost::asio::io_service::work> work;
+
+    /*!
+     * Threads with running writer objects or their event loop, they drain
+     * their queues when stopped.
+     */
+    thread_group threads { [this, &work]()
+    {
+        for (auto& w: writers_)
+        {
+            w->interrupt();
+        }
+
+        work.reset();
+    } };
+
+    if (opts_.async)
+    {
+        work.reset(new boost::asio::io_service::work(io));
+
+        for (auto& w: writers_)
+        {
+            w->start(io);
+        }
+
+        /*
+         * One thread keeps all shards busy.
+         */
+        threads.start([&io]()
+        {
+            io.run();
+        });
+    }
+    else
+    {
+        for (auto& w: writers_)
+        {
+            threads.start([&w]()
+            {
+                w->run();
+            });
+        }
+    }
+
+    batch_type batch;
+
+    batch.reserve(opts_.batch_size);
+
+    /*!
+     * Tracker ids reloaded in the background.
+     */
+    id_loader::cache_type loaded;
+
+    /*!
+     * Live batches taken since the last backlog one.
+     */
+    unsigned live_batches = 0;
+
+    /*
+     * Do not wait for a batch to fill up here, writers do their own
+     * batching. Wake up every now and then for housekeeping.
+     */
+    for (;;)
+    {
+        /*
+         * A stopped saver does not wait for the database to save queued
+         * reports when they can be spooled instead.
+         */
+        if (spool_ && interrupted_)
+            break;
+
+        std::chrono::milliseconds timeout { 1000 };
+
+        /*
+         * While the spool is not empty new reports go there, so
+         * the queue is drained first and the spool is replayed once
+         * the database catches up.
+         */
+        bool replay = spool_ && spool_->size();
+
+        if (replay)
+            timeout = std::chrono::milliseconds { pressure() ? 100 : 0 };
+
+        /*
+         * Parked reports are dispatched as soon as their trackers
+         * are resolved.
+         */
+        if (!parked_.empty())
+            timeout = std::min(timeout, std::chrono::milliseconds { 10 });
+
+        /*
+         * Backlog is taken when there are no live reports, the live queue
+         * isn't waited for while there is some. A steady live stream does
+         * not starve it, every few batches one is taken from the backlog.
+         */
+        bool more = true;
+
+        if (bulk_.size() && ++live_batches >= bulk_interval)
+        {
+            live_batches = 0;
+
+            bulk_.pop(batch, opts_.bulk_batch_size,
+                      std::chrono::milliseconds { 0 });
+        }
+        else
+        {
+            if (bulk_.size())
+                timeout = std::chrono::milliseconds { 0 };
+
+            more = queue_.pop(batch, opts_.batch_size, timeout);
+
+            if (batch.empty())
+            {
+                live_batches = 0;
+
+                more = bulk_.pop(batch, opts_.bulk_batch_size,
+                                 std::chrono::milliseconds { 0 }) || more;
+            }
+        }
+
+        if (!more)
+            break;
+
+        /*
+         * Replayed reports of unresolved trackers would go right back
+         * to the spool while the parking is full.
+         */
+        if (replay && batch.empty() && !pressure() &&
+            parked_size_ < opts_.max_parked)
+            stats_.replayed += unspool(batch);
+
+        /*
+         * Parked reports go first, they arrived earlier.
+         */
+        resolve();
+
+        dispatch(batch);
+        batch.clear();
+
+        if (loader_ && loader_->take(loaded))
+        {
+            fill(loaded);
+            loaded.clear();
+
+            YS_LOG(debug) << "Tracker ids cache refreshed";
+        }
+
+        purge_unknown();
+
+        publish_ids(false);
+
+        flush_states(false);
+
+        report_stats();
+    }
+
+    /*
+     * Give the resolver a moment to resolve parked reports, the ones left
+     * are spooled to be saved after a restart.
+     */
+    for (int i = 0; i < 100 && !parked_.empty(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+        resolve();
+    }
+
+    resolver_thread.join();
+
+    /*
+     * Let the writers save or spool their queues and join them.
+     */
+    threads.join();
+
+    /*
+     * Reports left are spooled to be saved after a restart.
+     */
+    batch.clear();
+
+    for (auto& p: parked_)
+    {
+        batch.insert(batch.end(), p.second.begin(), p.second.end());
+    }
+
+    parked_.clear();
+    parked_size_ = 0;
+
+    if (std::size_t lost = spill_or_drop(batch))
+    {
+        YS_LOG(warning) << lost << " reports of " <<
+                        "trackers not resolved before stopping are lost";
+    }
+
+    batch.clear();
+
+    if (spool_)
+    {
+        for (auto q: { &queue_, &bulk_ })
+        {
+            while (q->pop(batch, opts_.batch_size,
+                          std::chrono::milliseconds { 0 }))
+            {
+                spill_or_drop(batch);
+                batch.clear();
+            }
+        }
+    }
+
+    flush_states(true);
+
+    loader_thread.join();
+}
+
+/*!
+ * Interrupt execution, queued reports are saved or spooled if there
+ * is a spool.
+ */
+void
+saver::interrupt()
+{
+    interrupted_ = true;
+
+    queue_.interrupt();
+    bulk_.interrupt();
+}
+
+/*!
+ * Move a batch of data to the saver queue.
+ * \param batch Reports to add, the vector is cleared.
+ */
+void
+saver::push(std::vector<report>& batch)
+{
+    int64_t now = std::time(nullptr);
+
+    /*
+     * Partitioned in place, a stable partition may take a buffer from
+     * the heap. The order of reports is not kept anyway: lanes are saved
+     * independently, states keep the newest position and the duplicates
+     * filter does not depend on the order.
+     */
+    auto bulk = std::partition(batch.begin(), batch.end(),
+                               [this, now](report const& d)
+    {
+        return classify(d, now) == lane::live;
+    });
+
+    push(queue_, batch.begin(), bulk);
+    push(bulk_, bulk, batch.end());
+
+    batch.clear();
+}
+
+/*!
+ * Get a lane of the report by its age.
+ * \param d
+ * \param now Current time.
+ * \return
+ */
+lane
+saver::classify(report const& d, int64_t now) const
+{
+    return d.datetime < now - opts_.live_age ? lane::bulk : lane::live;
+}
+
+/*!
+ * Move a range of reports to a queue, spilling them to the spool
+ * when required.
+ *
+ * The worker thread is never blocked, reports which fit neither
+ * the spool nor any queue are dropped.
+ *
+ * \param queue
+ * \param first
+ * \param last
+ */
+void
+saver::push(queue_type& queue, batch_type::iterator first,
+            batch_type::iterator last)
+{
+    auto it = first;
+
+    while (it != last)
+    {
+        /*
+         * Once anything is spooled, the following reports are spooled too
+         * until the spool is replayed, so that the order is kept.
+         */
+        if (spool_ && (spool_->size() || pressure()))
+        {
+            std::size_t n = spill(it, last);
+
+            if (n)
+            {
+                it += n;
+                continue;
+            }
+        }
+
+        std::size_t n = queue.push(it, last);
+
+        if (n)
+        {
+            it += n;
+            continue;
+        }
+
+        /*
+         * The queue is full, the reports are spilled or go to the other
+         * queue, they are classified again when dispatched anyway.
+         */
+        n = spool_ ? spill(it, last) : 0;
+
+        if (!n)
+            n = (&queue == &queue_ ? bulk_ : queue_).push(it, last);
+
+        if (!n)
+            break;
+
+        it += n;
+    }
+
+    /*
+     * Waiting for room would stall all connections of the worker, so the
+     * rest is dropped, a spool keeps reports under such a load.
+     */
+    if (it != last)
+    {
+        YS_LOG(debug) << "Saver queues are full, dropped " <<
+                      last - it << " reports";
+
+        stats_.overflows += last - it;
+
+        acks_.release(it, last, [](report const& d) -> report const&
+        {
+            return d;
+        });
+    }
+}
+
+/*!
+ * Write a range of reports to the spool.
+ * \param first
+ * \param last
+ * \return Number of spooled reports, the first ones of the range.
+ */
+std::size_t
+saver::spill(batch_type::iterator first, batch_type::iterator last)
+{
+    auto it = first;
+
+    try
+    {
+        for (; it != last; ++it)
+        {
+            spool_->push(*it);
+        }
+    }
+    catch (std::exception const& e)
+    {
+        YS_LOG(error) << "Failed to spool report: " << e.what();
+    }
+
+    /*
+     * A spooled report is as good as saved once it is on the disk.
+     * If that fails, it is still replayed unless the host goes down.
+     */
+    try
+    {
+        spool_->sync();
+    }
+    catch (std::exception const& e)
+    {
+        YS_LOG(error) << e.what();
+    }
+
+    stats_.spooled += it - first;
+
+    acks_.release(first, it, [](report const& d) -> report const&
+    {
+        return d;
+    });
+
+    return it - first;
+}
+
+/*!
+ * Write a batch of reports to the spool, the ones which cannot be
+ * spooled are dropped.
+ * \param batch
+ * \return Number of dropped reports.
+ */
+std::size_t
+saver::spill_or_drop(batch_type& batch)
+{
+    std::size_t spooled = spool_ ? spill(batch.begin(), batch.end()) : 0;
+
+    if (spooled == batch.size())
+        return 0;
+
+    stats_.dropped += batch.size() - spooled;
+
+    acks_.release(batch.begin() + spooled, batch.end(),
+                  [](report const& d) -> report const&
+    {
+        return d;
+    });
+
+    return batch.size() - spooled;
+}
+
+/*!
+ * Read a batch of reports from the spool to be saved.
+ * \param batch Output vector, reports are appended to it.
+ * \return Number of read reports.
+ */
+std::size_t
+saver::unspool(batch_type& batch)
+{
+    std::size_t first = batch.size();
+    uint64_t mark;
+
+    std::size_t n = spool_->pop(batch, opts_.batch_size, mark);
+
+    /*
+     * The read is committed once every report of it is saved, spooled
+     * again or given up, the reports are read again after a restart
+     * until then.
+     */
+    uint32_t ticket = acks_.open([this, mark](uint32_t)
+    {
+        spool_->commit(mark);
+    });
+
+    acks_.retain(ticket, n);
+
+    for (std::size_t i = first; i < batch.size(); ++i)
+    {
+        batch[i].ack = ticket;
+    }
+
+    acks_.release(ticket);
+
+    return n;
+}
+
+/*!
+ * Check whether the report is a retransmit of a saved one.
+ * \param id Tracker id.
+ * \param d
+ * \return
+ */
+bool
+saver::duplicate(uint32_t id, report const& d)
 {
+    if (!dedup_.seen(id, d))
+        return false;
+
+    ++stats_.duplicates;
+
+    return true;
+}
 
 /*!
- * Constructor.
- * \param db Database connections.
+ * Get delivery tickets of reports waiting to be committed.
+ * \return
  */
-saver::saver(ys::db::pool& db) :
-    db_ { db }
+ack_table&
+saver::acks()
 {
+    return acks_;
 }
 
 /*!
- * Start the saver process.
+ * Get tracker ids shared with workers.
+ * \return
  */
-void
-saver::run()
+tracker_registry&
+saver::registry()
+{
+    return registry_;
+}
+
+/*!
+ * Get shard writers.
+ * \return
+ */
+std::vector<saver::writer_ptr> const&
+saver::writers() const
+{
+    return writers_;
+}
+
+/*!
+ * Check whether the database falls behind, so that new reports must go
+ * to the spool.
+ * \return
+ */
+bool
+saver::pressure() const
 {
-    queue_type::value_type el;
+    std::size_t depth = queue_.size() + bulk_.size();
 
-    while (queue_.pop(&el))
+    for (auto& w: writers_)
     {
-        save(el);
+        depth += w->depth();
+
+        if (opts_.spool_latency > 0 &&
+            w->stats().last_commit_time >
+            static_cast<uint64_t>(opts_.spool_latency) * 1000)
+            return true;
     }
+
+    return depth >= opts_.spool_depth;
 }
 
 /*!
- * Interrupt execution.
+ * Fill the tracker ids cache from the snapshot or with a bulk query.
  */
 void
-saver::interrupt()
+saver::warm_up()
 {
-    queue_.interrupt();
+    id_loader::cache_type ids;
+
+    /*
+     * A local snapshot is the fastest way, it is refreshed later
+     * in the background.
+     */
+    if (loader_ && loader_->read(ids))
+    {
+        fill(ids);
+
+        YS_LOG(info) << "Loaded " << ids.size() <<
+                     " tracker ids from " << opts_.id_snapshot;
+        return;
+    }
+
+    try
+    {
+        /*!
+         * Connection to load ids from, the same database they are
+         * reloaded and looked up in later.
+         */
+        pqxx::connection conn { ids_db_ };
+
+        id_loader::load(conn, ids);
+
+        if (loader_)
+            loader_->write(ids);
+
+        fill(ids);
+
+        YS_LOG(info) << "Loaded " << ids.size() << " tracker ids";
+    }
+    catch (std::exception const& e)
+    {
+        /*
+         * Not fatal, ids will be looked up one by one.
+         */
+        YS_LOG(error) << "Failed to load tracker ids: " << e.what();
+    }
 }
 
 /*!
- * Add data to the saver queue.
- * \param d
+ * Replace the tracker ids cache with loaded ids, keeping the entries
+ * of missing trackers.
+ * \param ids
  */
 void
-saver::push(parser::data_type const& d)
+saver::fill(id_loader::cache_type const& ids)
+{
+    id_table table { ids.size() };
+
+    for (auto& e: ids)
+    {
+        id_table::key_type key
+        {
+            e.number.data(), e.number.size(),
+            type_registry::intern(e.type), e.sim
+        };
+
+        /*
+         * Ids are ordered, the lowest one wins when sim numbers are shared.
+         */
+        if (!table.find(key))
+        {
+            if (auto v = table.insert(key))
+                v->id = e.id;
+        }
+    }
+
+    ids_.for_each([&table](id_table::key_type const& key,
+                           id_table::value_type const& value)
+    {
+        if ((value.id == 0 || value.id == pending_id) && !table.find(key))
+            *table.insert(key) = value;
+    });
+
+    ids_.swap(table);
+    ids_changed_ = true;
+}
+
+/*!
+ * Get saver statistics.
+ * \return
+ */
+saver::stats_type const&
+saver::stats() const
 {
-    queue_.push(d);
+    return stats_;
 }
 
 /*!
- * Save parser data in database.
+ * Resolve tracker ids of a batch of reports and route them to writers.
+ * \param batch
  */
 void
-saver::save(parser::data_type const& d)
+saver::dispatch(batch_type& batch)
 {
     /*!
-     * Tracker ID.
+     * Live reports grouped by writers.
+     */
+    std::vector<std::vector<writer::row_type>> live(writers_.size());
+
+    /*!
+     * Backlog reports grouped by writers.
      */
-    uint32_t id = get_id(d.num, d.phone, d.type);
+    std::vector<std::vector<writer::row_type>> bulk(writers_.size());
 
     /*!
-     * Suitable connection.
+     * Reports of trackers being resolved with no room to wait.
      */
-    auto conn_ptr = db_[id % db_.size()];
+    batch_type overflow;
+
+    int64_t now = std::time(nullptr);
+
+    for (auto& d: batch)
+    {
+        /*!
+         * Tracker ID.
+         */
+        uint32_t id = get_id(d);
+
+        if (id == pending_id)
+        {
+            park(d, overflow);
+            continue;
+        }
+
+        /*
+         * Reports of unknown trackers never reach a database.
+         */
+        if (id == 0)
+        {
+            ++stats_.dropped;
+            acks_.release(d.ack);
+
+            YS_LOG(debug) << "Dropped report of unknown tracker: " << d;
+
+            continue;
+        }
+
+        if (!opts_.state_table.empty())
+            states_.update(id, d);
+
+        /*
+         * Keep-alives only refresh the tracker state.
+         */
+        if (d.alive)
+        {
+            ++stats_.alive;
+            acks_.release(d.ack);
+            continue;
+        }
+
+        /*
+         * Trackers resend stored reports after reconnecting, there is
+         * no need to write them again. Workers drop most of them, here
+         * the ones of trackers workers did not know the ids of are found.
+         * Only committed reports are remembered, so the reply to a
+         * retransmit never gets ahead of the original being saved.
+         */
+        if (duplicate(id, d))
+        {
+            acks_.release(d.ack);
+            continue;
+        }
+
+        /*
+         * Reports are classified again, they may have aged in the queue
+         * or while their tracker was being resolved.
+         */
+        auto& routes = classify(d, now) == lane::live ? live : bulk;
+
+        routes[ring_.shard(id)].emplace_back(id, std::move(d));
+    }
 
     /*!
-     * Transaction.
+     * Reports past the capacity of their writer queues.
      */
-    pqxx::work tx { *conn_ptr };
+    batch_type full;
+
+    /*
+     * Reports of a tracker always go to the same writer lane,
+     * so their order is kept. A shard falling behind does not pile
+     * up reports in memory, live ones take the room of its queue first.
+     */
+    for (std::size_t i = 0; i < writers_.size(); ++i)
+    {
+        std::size_t depth = writers_[i]->depth();
 
-    tx.exec("select trackers.loginsert(" +
-            tx.quote(id) + ", " +
-            tx.quote(d.datetime) + ", " +
-            tx.quote(d.lon) + ", " +
-            tx.quote(d.lat) + ", " +
-            tx.quote(static_cast<uint32_t>(d.speed)) + ", " +
-            tx.quote(d.odometer) + ", " +
-            tx.quote(static_cast<int32_t>(d.course)) + ", " +
-            tx.quote(d.sats_glonass) + ", " +
-            tx.quote(d.sats_gps) + ")"
-           );
+        for (lane l: { lane::live, lane::bulk })
+        {
+            auto& rows = (l == lane::live ? live : bulk)[i];
+            std::size_t room = opts_.writer_queue_size > depth ?
+                               opts_.writer_queue_size - depth : 0;
+            std::size_t n = std::min(room, rows.size());
 
-    tx.commit();
+            for (auto it = rows.begin() + n; it != rows.end(); ++it)
+            {
+                full.push_back(it->second);
+            }
+
+            if (n)
+                writers_[i]->push(l, rows.begin(), rows.begin() + n);
+
+            depth += n;
+        }
+    }
+
+    if (!full.empty())
+    {
+        std::size_t spooled = spool_ ? spill(full.begin(), full.end()) : 0;
+
+        if (spooled < full.size())
+        {
+            YS_LOG(debug) << "Writer queues are full, dropped " <<
+                          full.size() - spooled << " reports";
+
+            stats_.overflows += full.size() - spooled;
+
+            acks_.release(full.begin() + spooled, full.end(),
+                          [](report const& d) -> report const&
+            {
+                return d;
+            });
+        }
+    }
+
+    /*
+     * While the lookup databases are down the parking fills up, the rest
+     * is replayed from the spool once they are back.
+     */
+    if (!overflow.empty())
+    {
+        std::size_t lost = spill_or_drop(overflow);
+
+        if (lost)
+        {
+            YS_LOG(debug) << "Dropped " << lost << " reports of " <<
+                          "trackers being resolved";
+        }
+    }
 }
 
 /*!
- * Get tracker id from `num` or `phone`, and `type`.
- * \param num
- * \param phone
- * \param type
+ * Get tracker id from the report number and type.
+ * \param d
+ * \return Tracker id, 0 for unknown trackers or `pending_id` while
+ *         the id is being resolved.
  */
 uint32_t
-saver::get_id(std::string const& num, std::string const& phone,
-              std::string const& type)
+saver::get_id(report const& d)
 {
-    std::string key = num + ':' + type;
+    if (d.number_size == 0)
+        return 0;
+
+    /*!
+     * Cache key, refers to the report number.
+     */
+    id_table::key_type key { d.number, d.number_size, d.type, d.sim };
+
+    auto now = clock_type::now().time_since_epoch().count();
 
     /*
-     * First, try to find id in the cache.
+     * First, try to find id in the cache, including trackers already
+     * known to be missing.
      */
 
-    auto id_it = id_cache_.find(key);
+    auto value = ids_.find(key);
 
-    if (id_it != id_cache_.end())
-    {
-        return id_it->second;
-    }
+    if (value && (value->id || value->expires > now))
+        return value->id;
 
     /*
-     * Not found, take it from db.
+     * Not found, have it resolved in the background. The report waits
+     * for that aside together with the following reports of the tracker.
      */
 
-    pqxx::work tx { *db_[0] };
+    value = ids_.insert(key);
+
+    if (!value)
+        return 0;
+
+    value->id = pending_id;
+
+    ++stats_.lookups;
+
+    resolver_->push({ d.get_number(), d.type, d.sim, 0 });
+
+    return pending_id;
+}
+
+/*!
+ * Set a report aside until its tracker id is resolved.
+ * \param d
+ * \param overflow Reports past the parking limit, the report is added
+ *        to it if there is no room.
+ */
+void
+saver::park(report const& d, batch_type& overflow)
+{
+    if (parked_size_ >= opts_.max_parked)
+    {
+        overflow.push_back(d);
+        return;
+    }
+
+    auto key = parking_key(d.number, d.number_size, d.type, d.sim);
+
+    parked_[key].push_back(d);
 
-    uint32_t id;
+    ++parked_size_;
+}
+
+/*!
+ * Put resolved tracker ids into the cache and dispatch reports which
+ * were waiting for them.
+ */
+void
+saver::resolve()
+{
+    if (!resolver_->take(resolved_))
+        return;
 
-    if (!num.empty())
+    auto now = clock_type::now().time_since_epoch().count();
+
+    for (auto& r: resolved_)
     {
+        auto value = ids_.insert({ r.number.data(), r.number.size(),
+                                   r.type, r.sim });
+
+        if (!value)
+            continue;
+
+        value->id = r.id;
+
         /*
-         * Search by tracker num.
+         * A missing tracker is not asked for again until the entry
+         * expires.
          */
+        if (r.id == 0)
+        {
+            ++stats_.unknown;
 
-        auto rows = tx.exec("select id from trackers.trackers where "
-                            "num = " + tx.quote(num) + " and "
-                            "typeid = "
-                            "(select id from trackers.types where "
-                            "name = " + tx.quote(type) + ")");
+            value->expires = now +
+                std::chrono::duration_cast<clock_type::duration>(
+                    std::chrono::seconds { opts_.unknown_ttl }).count();
+        }
+    }
 
-        if (rows.empty())
-            /*
-             * No information with specified values exists.
-             */
-            return 0;
+    ids_changed_ = true;
 
-        /*!
-         * Required tracker id.
-         */
-        id = rows[0]["id"].as<uint32_t>();
+    /*
+     * Only reports of the resolved trackers are dispatched, the rest
+     * stay parked.
+     */
+    batch_type ready;
+
+    for (auto& r: resolved_)
+    {
+        auto it = parked_.find(parking_key(r.number.data(), r.number.size(),
+                                           r.type, r.sim));
+
+        if (it == parked_.end())
+            continue;
+
+        parked_size_ -= it->second.size();
+
+        ready.insert(ready.end(), std::make_move_iterator(it->second.begin()),
+                     std::make_move_iterator(it->second.end()));
+
+        parked_.erase(it);
     }
-    else if (!phone.empty())
+
+    resolved_.clear();
+
+    dispatch(ready);
+}
+
+/*!
+ * Remove expired entries of unknown trackers.
+ */
+void
+saver::purge_unknown()
+{
+    auto now = clock_type::now();
+
+    /*
+     * Expired entries are asked for again anyway, purging only frees
+     * the memory, so a short time to live does not purge all the time.
+     */
+    if (now - purge_time_ < std::max(min_purge_interval,
+                                     std::chrono::seconds {
+                                         opts_.unknown_ttl }))
+        return;
+
+    purge_time_ = now;
+
+    auto ticks = now.time_since_epoch().count();
+
+    ids_.erase_if([ticks](id_table::value_type const& value)
     {
-        /*
-         * Search by trackers sim number.
-         */
+        return value.id == 0 && value.expires <= ticks;
+    });
+
+    ids_changed_ = true;
+}
+
+/*!
+ * Publish changed tracker ids to workers.
+ * \param force Publish regardless of the publication interval.
+ */
+void
+saver::publish_ids(bool force)
+{
+    /*
+     * Snapshots left behind by readers slower than the interval are
+     * freed as soon as possible.
+     */
+    registry_.reclaim();
 
-        auto rows = tx.exec("select id from trackers.trackers where "
-                            "(sim = " + tx.quote(phone) +
-                            " or sim2 = " + tx.quote(phone) + ") and "
-                            "typeid = "
-                            "(select id from trackers.types where "
-                            "name = " + tx.quote(type) + ") limit 1");
+    if (!ids_changed_)
+        return;
 
-        if (rows.empty())
-            /*
-             * No information with specified values exists.
-             */
-            return 0;
+    auto now = clock_type::now();
 
-        /*!
-         * Required tracker id.
+    if (!force && now - publish_time_ <
+                  std::chrono::milliseconds { opts_.registry_interval })
+        return;
+
+    /*
+     * The whole table is copied, so changes are published in batches
+     * rather than one by one.
+     */
+    registry_.publish(ids_);
+
+    publish_time_ = now;
+    ids_changed_ = false;
+}
+
+/*!
+ * Write changed tracker states with one bulk upsert.
+ * \param force Flush regardless of the flush interval.
+ */
+void
+saver::flush_states(bool force)
+{
+    if (opts_.state_table.empty() || states_.dirty() == 0)
+        return;
+
+    auto now = clock_type::now();
+
+    if (!force &&
+        now - flush_time_ < std::chrono::seconds { opts_.state_interval })
+        return;
+
+    flush_time_ = now;
+
+    std::vector<state_table::entry> states;
+
+    states_.take(states);
+
+    /*!
+     * Array literals of state columns.
+     */
+    std::string ids, dts, lons, lats, speeds, courses, seens;
+
+    auto add = [](std::string& a, std::string const& v)
+    {
+        a += a.empty() ? '{' : ',';
+        a += v;
+    };
+
+    for (auto& s: states)
+    {
+        /*
+         * A tracker which has only sent keep-alives has no position.
          */
-        id = rows[0]["id"].as<uint32_t>();
+        auto fix = [&s](long long v)
+        {
+            return s.has_fix ? std::to_string(v) : std::string { "NULL" };
+        };
+
+        add(ids, std::to_string(s.id));
+        add(dts, fix(s.fix.datetime));
+        add(lons, fix(s.fix.lon));
+        add(lats, fix(s.fix.lat));
+        add(speeds, fix(s.fix.speed));
+        add(courses, fix(s.fix.course));
+        add(seens, std::to_string(s.last_seen));
     }
-    else
+
+    for (auto a: { &ids, &dts, &lons, &lats, &speeds, &courses, &seens })
     {
-        return 0;
+        *a += '}';
     }
 
     /*
-     * Save taken value in the cache.
+     * The states are written with the next flush if this one fails.
      */
 
-    id_cache_.insert({ key, id });
+    if (!states_db_.reconnect(0))
+    {
+        states_.restore(states);
+        return;
+    }
+
+    try
+    {
+        pqxx::work tx { *states_db_[0] };
+
+        tx.prepared("state_upsert")
+            (ids)(dts)(lons)(lats)(speeds)(courses)(seens)
+            .exec();
+
+        tx.commit();
+
+        stats_.states += states.size();
+    }
+    catch (pqxx::broken_connection const& e)
+    {
+        YS_LOG(error) << "Lookup connection is broken: " << e.what();
+
+        states_db_.broken(0);
+        states_.restore(states);
+    }
+    catch (std::exception const& e)
+    {
+        YS_LOG(error) << "Failed to flush " << states.size() <<
+                      " tracker states: " << e.what();
+
+        states_.restore(states);
+    }
+}
+
+/*!
+ * Log statistics if the reporting interval has passed.
+ */
+void
+saver::report_stats()
+{
+    if (opts_.stats_interval <= 0)
+        return;
+
+    auto now = clock_type::now();
+
+    if (now - stats_time_ < std::chrono::seconds { opts_.stats_interval })
+        return;
 
-    return id;
+    stats_time_ = now;
+
+    YS_LOG(info) << "Saver: " << stats_ << ", " <<
+                 "live " << queue_.size() << ", " <<
+                 "bulk " << bulk_.size() << ", " <<
+                 "parked " << parked_size_ << ", " <<
+                 "resolver queries " << resolver_->queries() << ", " <<
+                 "id snapshots " << registry_.snapshots() << ", " <<
+                 "tickets " << acks_.size() << ", " << acks_.stats() << ", " <<
+                 "states " << states_db_.health(0);
+
+    for (std::size_t i = 0; i < resolver_->db().size(); ++i)
+    {
+        YS_LOG(info) << "Lookup " << i << ": " << resolver_->db().health(i);
+    }
+
+    for (std::size_t i = 0; i < writers_.size(); ++i)
+    {
+        YS_LOG(info) << "Writer " << i << ": " <<
+                     "live " << writers_[i]->depth(lane::live) << ", " <<
+                     "bulk " << writers_[i]->depth(lane::bulk) << ", " <<
+                     writers_[i]->health() << ", " <<
+                     writers_[i]->stats();
+    }
 }
 
 } // namespace td
 } // namespace ys
-
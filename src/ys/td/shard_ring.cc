@@ -0,0 +1,146 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Consistent hash ring of database shards source file.
+ */
+
+#include <ys/td/shard_ring.h>
+
+#include <algorithm>
+#include <set>
+
+#include <ys/td/error.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Mix bits of a 64-bit value (MurmurHash3 finalizer).
+ * \param h
+ * \return
+ */
+uint64_t
+mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+/*!
+ * Get a hash of a string (FNV-1a), stable between runs and builds.
+ * \param s
+ * \return
+ */
+uint64_t
+hash(std::string const& s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for (unsigned char c: s)
+    {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+
+    return mix(h);
+}
+
+} // namespace
+
+/*!
+ * Number of ring points per a unit of shard weight.
+ */
+const unsigned shard_ring::points_per_weight;
+
+/*!
+ * Constructor.
+ * \param shards Database shards, in the order of connections.
+ * \throw error
+ */
+shard_ring::shard_ring(std::vector<config::db_shard> const& shards) :
+    size_ { shards.size() }
+{
+    /*!
+     * Names seen so far.
+     */
+    std::set<std::string> names;
+
+    for (std::size_t i = 0; i < shards.size(); ++i)
+    {
+        auto& s = shards[i];
+
+        if (!names.insert(s.name).second)
+            throw error("Duplicate shard name: %s", s.name.c_str());
+
+        for (unsigned p = 0; p < s.weight * points_per_weight; ++p)
+        {
+            points_.emplace_back(hash(s.name + '#' + std::to_string(p)), i);
+        }
+    }
+
+    if (points_.empty())
+        throw error("No shards with a positive weight");
+
+    /*
+     * Colliding points are ordered by shard names, so the result
+     * doesn't depend on the order of shards in the config.
+     */
+    std::sort(points_.begin(), points_.end(),
+              [&shards](std::pair<uint64_t, std::size_t> const& a,
+                        std::pair<uint64_t, std::size_t> const& b)
+    {
+        return a.first < b.first ||
+               (a.first == b.first &&
+                shards[a.second].name < shards[b.second].name);
+    });
+}
+
+/*!
+ * Get a shard of a tracker.
+ * \param id Tracker id.
+ * \return Shard index.
+ */
+std::size_t
+shard_ring::shard(uint32_t id) const
+{
+    uint64_t h = mix(id);
+
+    auto it = std::lower_bound(points_.begin(), points_.end(), h,
+                               [](std::pair<uint64_t, std::size_t> const& p,
+                                  uint64_t v)
+    {
+        return p.first < v;
+    });
+
+    /*
+     * The ring wraps around.
+     */
+    if (it == points_.end())
+        it = points_.begin();
+
+    return it->second;
+}
+
+/*!
+ * Get a number of shards.
+ * \return
+ */
+std::size_t
+shard_ring::size() const
+{
+    return size_;
+}
+
+} // namespace td
+} // namespace ys
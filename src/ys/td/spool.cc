@@ -0,0 +1,572 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Durable reports spool class source file.
+ */
+
+#include <ys/td/spool.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ys/td/error.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Segment file header.
+ */
+struct header
+{
+    /*!
+     * Magic number.
+     */
+    uint32_t magic;
+
+    /*!
+     * Format version.
+     */
+    uint32_t version;
+
+    /*!
+     * Offset of the first unread record.
+     */
+    uint64_t read_pos;
+};
+
+/*!
+ * Segment file magic number.
+ */
+const uint32_t spool_magic = 0x4c4f5053;
+
+/*!
+ * Segment file format version.
+ */
+const uint32_t spool_version = 3;
+
+/*!
+ * Segment file name suffix.
+ */
+const char spool_suffix[] = ".spool";
+
+/*!
+ * Write a directory entries to the disk.
+ * \param dir
+ * \return False on failure.
+ */
+bool
+sync_dir(std::string const& dir)
+{
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+
+    if (fd < 0)
+        return false;
+
+    bool ok = fsync(fd) == 0;
+
+    close(fd);
+
+    return ok;
+}
+
+} // namespace
+
+/*!
+ * Memory-mapped segment file.
+ */
+struct spool::segment
+{
+    /*!
+     * Segment sequence number.
+     */
+    uint64_t seq;
+
+    /*!
+     * File path.
+     */
+    std::string path;
+
+    /*!
+     * File descriptor.
+     */
+    int fd { -1 };
+
+    /*!
+     * Mapped file contents.
+     */
+    char* data { nullptr };
+
+    /*!
+     * File size.
+     */
+    std::size_t size { 0 };
+
+    /*!
+     * Offset past the last record.
+     */
+    std::size_t write_pos { sizeof(header) };
+
+    /*!
+     * Offset of the next record to read, the header keeps the offset
+     * of the first record not committed.
+     */
+    std::size_t read_pos { sizeof(header) };
+
+    /*!
+     * Offset up to which the file is written to the disk.
+     */
+    std::size_t sync_pos { 0 };
+
+    /*!
+     * Get the file header.
+     * \return
+     */
+    header&
+    hdr()
+    {
+        return *reinterpret_cast<header*>(data);
+    }
+
+    /*!
+     * Unmap and close the file.
+     */
+    ~segment()
+    {
+        if (data)
+        {
+            msync(data, size, MS_ASYNC);
+            munmap(data, size);
+        }
+
+        if (fd >= 0)
+            close(fd);
+    }
+};
+
+/*!
+ * Constructor, opens segments left by a previous run.
+ * \param dir Spool directory.
+ * \param segment_size Size of a segment file in bytes.
+ * \throw error
+ */
+spool::spool(std::string const& dir, std::size_t segment_size) :
+    dir_ { dir },
+    segment_size_ { segment_size }
+{
+    if (mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST)
+        throw error("Failed to create spool directory %s: %s",
+                    dir_.c_str(), std::strerror(errno));
+
+    DIR* d = opendir(dir_.c_str());
+
+    if (!d)
+        throw error("Failed to open spool directory %s: %s",
+                    dir_.c_str(), std::strerror(errno));
+
+    /*
+     * Collect sequence numbers of segments left by a previous run.
+     */
+
+    std::vector<uint64_t> seqs;
+
+    while (dirent* e = readdir(d))
+    {
+        uint64_t seq;
+
+        /*
+         * One character more than the suffix, so that a longer one
+         * does not match.
+         */
+        char suffix[sizeof(spool_suffix) + 1] {};
+
+        if (std::sscanf(e->d_name, "%" SCNu64 "%7s", &seq, suffix) == 2 &&
+            std::strcmp(suffix, spool_suffix) == 0)
+            seqs.push_back(seq);
+    }
+
+    closedir(d);
+
+    std::sort(seqs.begin(), seqs.end());
+
+    for (uint64_t seq: seqs)
+    {
+        segments_.push_back(open(seq, false));
+        next_seq_ = seq + 1;
+    }
+
+    trim();
+}
+
+/*!
+ * Destructor.
+ */
+spool::~spool()
+{
+}
+
+/*!
+ * Append a report.
+ * \param d
+ * \throw error
+ */
+void
+spool::push(report const& d)
+{
+    std::string buf;
+
+    encode(d, buf);
+
+    uint32_t n = buf.size();
+
+    if (sizeof(header) + sizeof(n) + n > segment_size_)
+        throw error("Report of %u bytes does not fit a spool segment", n);
+
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if (segments_.empty() ||
+        segments_.back()->write_pos + sizeof(n) + n > segments_.back()->size)
+    {
+        if (!segments_.empty())
+            msync(segments_.back()->data, segments_.back()->size, MS_ASYNC);
+
+        segments_.push_back(open(next_seq_++, true));
+    }
+
+    segment& s = *segments_.back();
+
+    /*
+     * The record becomes visible to a recovery scan only when its size
+     * is written, so the size goes last.
+     */
+    std::memcpy(s.data + s.write_pos + sizeof(n), buf.data(), n);
+    std::memcpy(s.data + s.write_pos, &n, sizeof(n));
+
+    s.write_pos += sizeof(n) + n;
+
+    ++size_;
+}
+
+/*!
+ * Write appended reports to the disk.
+ * \throw error
+ */
+void
+spool::sync()
+{
+    static const std::size_t page = sysconf(_SC_PAGESIZE);
+
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    for (auto& p: segments_)
+    {
+        segment& s = *p;
+
+        if (s.sync_pos >= s.write_pos)
+            continue;
+
+        /*
+         * Only the pages written since the previous call are flushed.
+         */
+        std::size_t from = s.sync_pos / page * page;
+
+        if (msync(s.data + from, s.write_pos - from, MS_SYNC) != 0)
+            throw error("Failed to sync spool segment %s: %s",
+                        s.path.c_str(), std::strerror(errno));
+
+        s.sync_pos = s.write_pos;
+    }
+}
+
+/*!
+ * Read up to `max` reports in the order they were appended.
+ * \param out Output vector, reports are appended to it.
+ * \param max Maximum number of reports to read.
+ * \param mark Output mark of the read to commit, 0 if nothing was
+ *             read.
+ * \return Number of read reports.
+ */
+std::size_t
+spool::pop(std::vector<report>& out, std::size_t max, uint64_t& mark)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    std::size_t count = 0;
+
+    /*!
+     * Segment of the last read record.
+     */
+    segment* last = nullptr;
+
+    /*
+     * Segments read through stay until their reads are committed.
+     */
+    for (auto& p: segments_)
+    {
+        segment& s = *p;
+
+        while (count < max && s.read_pos < s.write_pos)
+        {
+            uint32_t n;
+
+            std::memcpy(&n, s.data + s.read_pos, sizeof(n));
+
+            out.emplace_back();
+
+            /*
+             * A broken record is skipped, it can not be saved anyway.
+             */
+            if (decode(s.data + s.read_pos + sizeof(n), n, out.back()))
+                ++count;
+            else
+                out.pop_back();
+
+            s.read_pos += sizeof(n) + n;
+            last = &s;
+
+            --size_;
+        }
+
+        if (count == max)
+            break;
+    }
+
+    mark = 0;
+
+    if (last)
+    {
+        mark = first_mark_ + marks_.size();
+        marks_.push_back({ last->seq, last->read_pos, false });
+    }
+
+    return count;
+}
+
+/*!
+ * Commit a read once its reports are saved, the read position is
+ * stored when all the preceding reads are committed too.
+ * \param mark Mark of the read, 0 is ignored.
+ */
+void
+spool::commit(uint64_t mark)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if (mark < first_mark_ || mark - first_mark_ >= marks_.size())
+        return;
+
+    marks_[mark - first_mark_].done = true;
+
+    while (!marks_.empty() && marks_.front().done)
+    {
+        read_mark& m = marks_.front();
+
+        /*
+         * Segments before the one of the mark are read through.
+         */
+        for (auto& p: segments_)
+        {
+            if (p->seq < m.seq)
+                p->hdr().read_pos = p->write_pos;
+            else if (p->seq == m.seq)
+                p->hdr().read_pos = m.pos;
+        }
+
+        marks_.pop_front();
+        ++first_mark_;
+    }
+
+    trim();
+}
+
+/*!
+ * Get a number of unread reports.
+ * \return
+ */
+std::size_t
+spool::size() const
+{
+    return size_;
+}
+
+/*!
+ * Open a segment file, create it if required.
+ * \param seq Segment sequence number.
+ * \param create Create a new segment.
+ * \return
+ * \throw error
+ */
+spool::segment_ptr
+spool::open(uint64_t seq, bool create)
+{
+    segment_ptr s { new segment {} };
+
+    char name[32];
+
+    std::snprintf(name, sizeof(name), "%016" PRIu64 "%s", seq, spool_suffix);
+
+    s->seq = seq;
+    s->path = dir_ + '/' + name;
+    s->fd = ::open(s->path.c_str(), O_RDWR | (create ? O_CREAT | O_EXCL : 0),
+                   0644);
+
+    if (s->fd < 0)
+        throw error("Failed to open spool segment %s: %s",
+                    s->path.c_str(), std::strerror(errno));
+
+    /*
+     * The file and its size are made durable at once, the records are
+     * flushed by `sync`.
+     */
+    if (create && (ftruncate(s->fd, segment_size_) != 0 ||
+                   fsync(s->fd) != 0 || !sync_dir(dir_)))
+        throw error("Failed to allocate spool segment %s: %s",
+                    s->path.c_str(), std::strerror(errno));
+
+    struct stat st;
+
+    if (fstat(s->fd, &st) != 0 || st.st_size < (off_t)sizeof(header))
+        throw error("Invalid spool segment %s", s->path.c_str());
+
+    s->size = st.st_size;
+
+    void* data = mmap(nullptr, s->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      s->fd, 0);
+
+    if (data == MAP_FAILED)
+        throw error("Failed to map spool segment %s: %s",
+                    s->path.c_str(), std::strerror(errno));
+
+    s->data = static_cast<char*>(data);
+
+    header& h = s->hdr();
+
+    if (create)
+    {
+        h.magic = spool_magic;
+        h.version = spool_version;
+        h.read_pos = sizeof(header);
+
+        return s;
+    }
+
+    if (h.magic != spool_magic || h.version != spool_version)
+        throw error("Invalid spool segment %s", s->path.c_str());
+
+    if (h.read_pos < sizeof(header))
+        h.read_pos = sizeof(header);
+
+    /*
+     * Find the end of written records and count the unread ones.
+     */
+
+    for (;;)
+    {
+        uint32_t n;
+
+        if (s->write_pos + sizeof(n) > s->size)
+            break;
+
+        std::memcpy(&n, s->data + s->write_pos, sizeof(n));
+
+        if (n == 0 || s->write_pos + sizeof(n) + n > s->size)
+            break;
+
+        if (s->write_pos >= h.read_pos)
+            ++size_;
+
+        s->write_pos += sizeof(n) + n;
+    }
+
+    /*
+     * A read position past the written records is taken as the end.
+     */
+    if (h.read_pos > s->write_pos)
+        h.read_pos = s->write_pos;
+
+    s->read_pos = h.read_pos;
+    s->sync_pos = s->write_pos;
+
+    return s;
+}
+
+/*!
+ * Remove committed segments, except the last one which is being written.
+ */
+void
+spool::trim()
+{
+    while (segments_.size() > 1 &&
+           segments_.front()->hdr().read_pos == segments_.front()->write_pos)
+    {
+        unlink(segments_.front()->path.c_str());
+        segments_.pop_front();
+    }
+}
+
+/*!
+ * Encode a report.
+ * \param d
+ * \param buf Output buffer.
+ * \throw error
+ */
+void
+spool::encode(report const& d, std::string& buf)
+{
+    /*
+     * A report is a POD, it is stored as is up to its delivery ticket,
+     * which means nothing after a restart. Type ids are assigned anew
+     * by every run, so the type name follows the report.
+     */
+    std::string type = type_registry::name(d.type);
+
+    if (type.size() > UINT8_MAX)
+        throw error("Tracker type name is too long: %s", type.c_str());
+
+    buf.assign(reinterpret_cast<char const*>(&d), offsetof(report, ack));
+    buf.push_back(static_cast<char>(type.size()));
+    buf.append(type);
+}
+
+/*!
+ * Decode a report.
+ * \param p Encoded report.
+ * \param n Encoded report size.
+ * \param d Output report.
+ * \return False if the record is not a report.
+ */
+bool
+spool::decode(char const* p, std::size_t n, report& d)
+{
+    const std::size_t size = offsetof(report, ack);
+
+    if (n < size + 1 ||
+        n != size + 1 + static_cast<unsigned char>(p[size]))
+        return false;
+
+    d = report {};
+    std::memcpy(static_cast<void*>(&d), p, size);
+
+    d.type = type_registry::intern(std::string(p + size + 1, n - size - 1));
+
+    return true;
+}
+
+} // namespace td
+} // namespace ys
@@ -8,33 +8,78 @@
 #include <ys/td/st270_parser.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <ctime>
 #include <iterator>
-#include <string>
-#include <sstream>
-
-#include <boost/date_time.hpp>
-
-#include <ys/td/lib.h>
 
 namespace ys
 {
 namespace td
 {
 
+namespace
+{
+
 /*!
- * Constructor.
+ * Fields of a report with position data, counted from the start of
+ * the line, the header and the tracker number take the first two.
+ * The parser used to drop those two and then count from the start
+ * anyway, reading the date from the tracker number.
  */
-st270_parser::st270_parser() :
-    in_loc
+enum field
 {
-    std::locale::classic(),
-    new boost::posix_time::time_input_facet("%Y%m%d %H:%M:%S")
-},
-out_loc
+    f_header,
+    f_number,
+    f_sw_ver,
+    f_date,
+    f_time,
+    f_cell,
+    f_lat,
+    f_lon,
+    f_speed,
+    f_course,
+    f_sats_gps,
+    f_sats_glonass,
+    f_fix,
+    f_alt,
+    f_pulse_in1,
+    f_pulse_in2,
+    f_dist,
+    f_pwr_volt,
+    f_io,
+    f_an1,
+    f_an2,
+    f_an3,
+    f_an4,
+    f_to,
+    f_tf,
+    f_vs,
+
+    /*!
+     * Number of fields a report must have.
+     */
+    f_count
+};
+
+/*!
+ * Check whether a value lies within a range.
+ * \param v
+ * \param min
+ * \param max
+ * \return
+ */
+bool
+within(int64_t v, int64_t min, int64_t max)
 {
-    std::locale::classic(),
-    new boost::posix_time::time_facet("%Y-%m-%d %H:%M:%S")
+    return v >= min && v <= max;
 }
+
+} // namespace
+
+/*!
+ * Constructor.
+ */
+st270_parser::st270_parser()
 {
 }
 
@@ -44,82 +89,50 @@ out_loc
 parser::result_type
 st270_parser::parse()
 {
-    std::string report = get_report_string();
+    auto first = buffer_.begin();
 
-    if (report.empty())
-        return { false };
-
-    return parse_report(report);
-}
-
-/*!
- * Get ST270 report string.
- * \return
- */
-std::string
-st270_parser::get_report_string()
-{
     /*!
      * A pointer to the report delimiter.
      */
-    auto it = std::find(buffer_.begin(), buffer_.end(), '\r');
+    auto it = std::find(first, buffer_.end(), '\r');
 
     /*
-     * If delimiter was not then then the packet is not full.
+     * If delimiter was not found then the packet is not full.
      */
     if (it == buffer_.end())
-        return "";
-
-    /*!
-     * A report string.
-     */
-    std::string report { buffer_.begin(), it };
+        return { false };
 
     /*
-     * Remove the packet data from the buffer.
+     * The report is parsed right in the buffer and removed after that.
      */
-    consume(std::next(it));
-
-    return report;
-}
-
-/*!
- * Get function for reading packet data.
- * \param hdr Packet header.
- * \return
- */
-std::function<bool(std::vector<std::string>&)>
-st270_parser::get_read_fn(std::string const& hdr)
-{
-    using namespace std::placeholders;
-
-    if (hdr == "ST270STT")
-        return std::bind(&st270_parser::read_status_report, this, _1);
+    tokenizer::field_type report
+    {
+        reinterpret_cast<char const*>(first),
+        static_cast<std::size_t>(std::distance(first, it))
+    };
 
-    if (hdr == "ST270EMG")
-        return std::bind(&st270_parser::read_emergency_report, this, _1);
+    parser::result_type res { false };
 
-    if (hdr == "ST270EVT")
-        return std::bind(&st270_parser::read_event_report, this, _1);
+    if (!report.empty())
+        res = parse_report(report);
 
-    if (hdr == "ST270ALT")
-        return std::bind(&st270_parser::read_alert_report, this, _1);
+    consume(std::next(it));
 
-    return nullptr;
+    return res;
 }
 
 /*!
  * Parse report string.
- * \param s
+ * \param s Report line, it refers to the parser buffer.
  * \return
  */
 parser::result_type
-st270_parser::parse_report(std::string const& s)
+st270_parser::parse_report(tokenizer::field_type s)
 {
     /*!
-     * Vector with report values.
+     * Report values, they refer to the line.
      */
-    auto v = split(s, ';');
+    tokenizer v { s, ';' };
 
     /*
      * If there are less than two elements then the packet is corrupt.
@@ -130,176 +143,101 @@ st270_parser::parse_report(std::string const& s)
     /*!
      * Report header.
      */
-    std::string hdr = v[0];
-
-    data_.num = v[1];
+    auto hdr = v[f_header];
 
     /*
-     * Skip parsing in the case of alive report.
+     * A tracker number which does not fit a report is corrupt.
      */
-    if (hdr == "ST270ALV")
-        return { true, true };
-
-    auto fn = get_read_fn(hdr);
-
-    /*
-     * If reading function determination failed then the tracker is corrupt.
-     */
-    if (!fn)
+    if (!data_.set_number(v[f_number].data(), v[f_number].size()))
         return { false, false, true };
 
-    return { fn(v) };
-}
-
-/*!
- * Read status report data.
- * \param v Vector with report values.
- * \return
- */
-bool
-st270_parser::read_status_report(std::vector<std::string>& v)
-{
-    /*
-     * Attempt to read tracker data.
-     */
-    if (!read_report_data(v))
-        return false;
-
     /*
-     * Remaining packet variables.
+     * An alive report only tells the tracker is online, it is stamped
+     * with the time of arrival.
      */
-    std::string mode, msg_num;
+    data_.alive = hdr == "ST270ALV";
 
-    vec2vars(v, mode, msg_num);
+    if (data_.alive)
+    {
+        data_.datetime = std::time(nullptr);
+        return { true };
+    }
 
-    return true;
-}
-
-/*!
- * Read emergency report data.
- * \param v Vector with report values.
- * \return
- */
-bool
-st270_parser::read_emergency_report(std::vector<std::string>& v)
-{
     /*
-     * Attempt to read tracker data.
+     * If the report type is unknown then the tracker is corrupt.
      */
-    if (!read_report_data(v))
-        return false;
-
-    /*
-     * Remaining packet variables.
-     */
-    std::string emg_id;
-
-    vec2vars(v, emg_id);
+    if (!has_position(hdr))
+        return { false, false, true };
 
-    return true;
+    return { read_report_data(v) };
 }
 
 /*!
- * Read event report data.
- * \param v Vector with report values.
+ * Check whether the header is one of a report with position data.
+ * \param hdr Packet header.
  * \return
  */
 bool
-st270_parser::read_event_report(std::vector<std::string>& v)
+st270_parser::has_position(tokenizer::field_type hdr)
 {
     /*
-     * Attempt to read tracker data.
+     * Status, emergency, event and alert reports differ only in their
+     * trailing fields, which are not stored.
      */
-    if (!read_report_data(v))
-        return false;
-
-    /*
-     * Remaining packet variables.
-     */
-    std::string evt_id;
-
-    vec2vars(v, evt_id);
-
-    return true;
+    return hdr == "ST270STT" || hdr == "ST270EMG" ||
+           hdr == "ST270EVT" || hdr == "ST270ALT";
 }
 
 /*!
- * Read alert report data.
- * \param v Vector with report values.
+ * Read data from the report packet.
+ * \param v Report values.
  * \return
  */
 bool
-st270_parser::read_alert_report(std::vector<std::string>& v)
+st270_parser::read_report_data(tokenizer const& v)
 {
     /*
-     * Attempt to read tracker data.
+     * Check whether there is sufficient number of data.
      */
-    if (!read_report_data(v))
+    if (v.size() < f_count)
         return false;
 
     /*
-     * Remaining packet variables.
-     */
-    std::string alert_id;
-
-    vec2vars(v, alert_id);
-
-    return true;
-}
-
-/*!
- * Read data from the report packet.
- * \param v Vector of report values.
- * \return
- */
-bool
-st270_parser::read_report_data(std::vector<std::string>& v)
-{
-    /*
-     * Packet variables.
+     * Only the stored fields are decoded.
      */
-    std::string sw_ver, date, time, cell, lat, lon, spd, crs,
-        satt_gps, satt_glonass, fix, alt, pulse_in1, pulse_in2,
-        dist, pwr_volt, io, an1, an2, an3, an4, to, tf, vs;
+    if (!parse_epoch(v[f_date], v[f_time], data_.datetime))
+        return false;
 
-    /*!
-     * Number of read variables.
-     */
-    const int var_num = 24;
+    int64_t lat, lon, speed, course, sats_gps, sats_glonass, dist;
 
-    /*
-     * Check whether there is sufficient number of data.
-     */
-    if (v.size() < var_num)
+    if (!parse_fixed(v[f_lat], 6, lat) || !parse_fixed(v[f_lon], 6, lon) ||
+        !parse_int(v[f_speed], speed) || !parse_int(v[f_course], course) ||
+        !parse_int(v[f_sats_gps], sats_gps) ||
+        !parse_int(v[f_sats_glonass], sats_glonass) ||
+        !parse_int(v[f_dist], dist))
         return false;
 
     /*
-     * Load data into variables.
+     * A value the report cannot hold is corrupt, it is not truncated.
      */
-    vec2vars(v, sw_ver, date, time, cell, lat, lon, spd, crs,
-             satt_gps, satt_glonass, fix, alt, pulse_in1, pulse_in2,
-             dist, pwr_volt, io, an1, an2, an3, an4, to, tf, vs);
-
-    /*
-     * Fill tracker data variables.
-     */
-    data_.datetime = conv_datetime(date + " " + time, in_loc, out_loc);
-    data_.lat = parse_string<double>(lat);
-    data_.lon = parse_string<double>(lon);
-    data_.speed = parse_string<double>(spd);
-    data_.course = parse_string<double>(crs);
-    data_.sats_gps = parse_string<int>(satt_gps);
-    data_.sats_glonass = parse_string<int>(satt_glonass);
-    data_.odometer = parse_string<int>(dist) / 1000;
+    if (!within(lat, -90000000, 90000000) ||
+        !within(lon, -180000000, 180000000) ||
+        !within(speed, 0, UINT16_MAX) || !within(course, 0, UINT16_MAX) ||
+        !within(sats_gps, 0, UINT8_MAX) ||
+        !within(sats_glonass, 0, UINT8_MAX) ||
+        !within(dist, 0, (UINT32_MAX + 1LL) * 1000 - 1))
+        return false;
 
-    /*
-     * Remove processed variables from the vector of report variables.
-     */
-    v.erase(v.begin(), std::next(v.begin(), var_num));
+    data_.lat = lat;
+    data_.lon = lon;
+    data_.speed = speed;
+    data_.course = course;
+    data_.sats_gps = sats_gps;
+    data_.sats_glonass = sats_glonass;
+    data_.odometer = dist / 1000;
 
     return true;
 }
 
 } // namespace td
 } // namespace ys
-
@@ -0,0 +1,107 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Trackers latest state table source file.
+ */
+
+#include <ys/td/state_table.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Update the tracker state with a report.
+ * \param id Tracker id.
+ * \param d
+ */
+void
+state_table::update(uint32_t id, report const& d)
+{
+    entry& s = touch(id).state;
+
+    if (d.datetime > s.last_seen)
+        s.last_seen = d.datetime;
+
+    /*
+     * Reports replayed from the spool may be older than the ones already
+     * seen, the state keeps the latest position.
+     */
+    if (!d.alive && (!s.has_fix || d.datetime >= s.fix.datetime))
+    {
+        s.fix = d;
+        s.has_fix = true;
+    }
+}
+
+/*!
+ * Move states changed since the last call into `out`.
+ * \param out Output vector, states are appended to it.
+ */
+void
+state_table::take(std::vector<entry>& out)
+{
+    out.reserve(out.size() + dirty_.size());
+
+    for (uint32_t id: dirty_)
+    {
+        item& i = items_[id];
+
+        out.push_back(i.state);
+        i.dirty = false;
+    }
+
+    dirty_.clear();
+}
+
+/*!
+ * Mark states as changed again, e.g. after a failed flush.
+ * \param states
+ */
+void
+state_table::restore(std::vector<entry> const& states)
+{
+    for (auto& s: states)
+    {
+        touch(s.id);
+    }
+}
+
+/*!
+ * Get a number of changed states.
+ * \return
+ */
+std::size_t
+state_table::dirty() const
+{
+    return dirty_.size();
+}
+
+/*!
+ * Get an item of the tracker, marking it changed.
+ * \param id
+ * \return
+ */
+state_table::item&
+state_table::touch(uint32_t id)
+{
+    auto ins = items_.emplace(id, item {});
+
+    item& i = ins.first->second;
+
+    if (ins.second)
+        i.state.id = id;
+
+    if (!i.dirty)
+    {
+        i.dirty = true;
+        dirty_.push_back(id);
+    }
+
+    return i;
+}
+
+} // namespace td
+} // namespace ys
@@ -0,0 +1,239 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Allocation free report tokenizer source file.
+ */
+
+#include <ys/td/tokenizer.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Read exactly `n` decimal digits.
+ * \param s
+ * \param pos Position of the first digit.
+ * \param n Number of digits.
+ * \param v Output value.
+ * \return False if there are fewer digits.
+ */
+bool
+read_digits(tokenizer::field_type s, std::size_t pos, std::size_t n, int& v)
+{
+    if (pos + n > s.size())
+        return false;
+
+    v = 0;
+
+    for (std::size_t i = pos; i < pos + n; ++i)
+    {
+        if (s[i] < '0' || s[i] > '9')
+            return false;
+
+        v = v * 10 + (s[i] - '0');
+    }
+
+    return true;
+}
+
+/*!
+ * Get a number of days since the epoch of a civil date.
+ * \param y Year.
+ * \param m Month, 1 to 12.
+ * \param d Day of month.
+ * \return
+ */
+int64_t
+days_from_civil(int64_t y, int m, int d)
+{
+    /*
+     * Years start in March, so the leap day is the last one of a year.
+     */
+    y -= m <= 2;
+
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + doe - 719468;
+}
+
+/*!
+ * Append a decimal digit to a non-negative value.
+ * \param v
+ * \param digit
+ * \return False if the result does not fit, the value is unchanged.
+ */
+bool
+push_digit(int64_t& v, int digit)
+{
+    if (v > (INT64_MAX - digit) / 10)
+        return false;
+
+    v = v * 10 + digit;
+
+    return true;
+}
+
+} // namespace
+
+/*!
+ * Split a line.
+ * \param s Line.
+ * \param d Delimiter.
+ */
+tokenizer::tokenizer(field_type s, char d)
+{
+    for (;;)
+    {
+        std::size_t pos = size_ + 1 < max_fields ? s.find(d) : s.npos;
+
+        if (pos == s.npos)
+        {
+            fields_[size_++] = s;
+            return;
+        }
+
+        fields_[size_++] = s.substr(0, pos);
+        s.remove_prefix(pos + 1);
+    }
+}
+
+/*!
+ * Get a number of fields.
+ * \return
+ */
+std::size_t
+tokenizer::size() const
+{
+    return size_;
+}
+
+/*!
+ * Get a field.
+ * \param i Field index.
+ * \return Empty field if there is no such field.
+ */
+tokenizer::field_type
+tokenizer::operator[](std::size_t i) const
+{
+    return i < size_ ? fields_[i] : field_type {};
+}
+
+/*!
+ * Read a leading integer of a field the way a stream does, "15.30"
+ * is read as 15.
+ * \param s
+ * \param v Output value, 0 if the field does not start with a number.
+ * \return False if the value does not fit.
+ */
+bool
+parse_int(tokenizer::field_type s, int64_t& v)
+{
+    return parse_fixed(s, 0, v);
+}
+
+/*!
+ * Read a decimal fraction scaled by `10^digits` and rounded half away
+ * from zero, "+37.4786285" with 6 digits is read as 37478629.
+ * \param s
+ * \param digits Number of fraction digits kept.
+ * \param v Output value, 0 if the field does not start with a number.
+ * \return False if the value does not fit.
+ */
+bool
+parse_fixed(tokenizer::field_type s, unsigned digits, int64_t& v)
+{
+    std::size_t i = 0;
+    bool negative = false;
+
+    if (i < s.size() && (s[i] == '+' || s[i] == '-'))
+        negative = s[i++] == '-';
+
+    v = 0;
+
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i)
+    {
+        if (!push_digit(v, s[i] - '0'))
+            return false;
+    }
+
+    /*
+     * Missing fraction digits are zeros, the first dropped one rounds
+     * the value.
+     */
+    bool fraction = digits && i < s.size() && s[i] == '.';
+
+    if (fraction)
+        ++i;
+
+    for (unsigned n = 0; n < digits; ++n)
+    {
+        int digit = 0;
+
+        if (fraction && i < s.size() && s[i] >= '0' && s[i] <= '9')
+            digit = s[i++] - '0';
+
+        if (!push_digit(v, digit))
+            return false;
+    }
+
+    if (fraction && i < s.size() && s[i] >= '5' && s[i] <= '9')
+    {
+        if (v == INT64_MAX)
+            return false;
+
+        ++v;
+    }
+
+    if (negative)
+        v = -v;
+
+    return true;
+}
+
+/*!
+ * Get seconds since the epoch of a UTC date and time.
+ * \param date Date in `YYYYMMDD` format.
+ * \param time Time in `HH:MM:SS` format.
+ * \param epoch Output value.
+ * \return False if the date or time is not valid.
+ */
+bool
+parse_epoch(tokenizer::field_type date, tokenizer::field_type time,
+            int64_t& epoch)
+{
+    int y, m, d, hh, mm, ss;
+
+    if (date.size() != 8 || time.size() != 8 ||
+        time[2] != ':' || time[5] != ':' ||
+        !read_digits(date, 0, 4, y) || !read_digits(date, 4, 2, m) ||
+        !read_digits(date, 6, 2, d) || !read_digits(time, 0, 2, hh) ||
+        !read_digits(time, 3, 2, mm) || !read_digits(time, 6, 2, ss))
+        return false;
+
+    static const int month_days[] =
+    {
+        31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+
+    if (y < 1400 || m < 1 || m > 12 || d < 1 || d > month_days[m - 1] ||
+        (m == 2 && d == 29 && !leap) || hh > 23 || mm > 59 || ss > 59)
+        return false;
+
+    epoch = days_from_civil(y, m, d) * 86400 + hh * 3600 + mm * 60 + ss;
+
+    return true;
+}
+
+} // namespace td
+} // namespace ys
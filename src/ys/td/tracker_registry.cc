@@ -0,0 +1,171 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids registry shared between threads source file.
+ */
+
+#include <ys/td/tracker_registry.h>
+
+#include <algorithm>
+
+#include <ys/td/error.h>
+
+namespace ys
+{
+namespace td
+{
+
+/*!
+ * Take a free reader slot.
+ * \param r Registry.
+ * \throw error If all slots are taken.
+ */
+tracker_registry::reader::reader(tracker_registry& r) :
+    registry_ { r },
+    slot_ { 0 }
+{
+    for (; slot_ < max_readers; ++slot_)
+    {
+        bool taken = false;
+
+        if (registry_.slots_[slot_].taken.compare_exchange_strong(taken, true))
+            return;
+    }
+
+    throw error("All %zu tracker registry readers are taken", max_readers);
+}
+
+/*!
+ * Release the slot.
+ */
+tracker_registry::reader::~reader()
+{
+    registry_.slots_[slot_].taken = false;
+}
+
+/*!
+ * Find a tracker in the latest snapshot.
+ * \param k Key.
+ * \param v Output value.
+ * \return False if there is no such tracker.
+ */
+bool
+tracker_registry::reader::find(id_table::key_type const& k,
+                               id_table::value_type& v)
+{
+    auto& s = registry_.slots_[slot_];
+
+    /*
+     * The epoch is announced before the snapshot is taken. The writer
+     * either sees the reader in the epoch or the reader sees the newer
+     * snapshot, both are sequentially consistent.
+     */
+    s.epoch = registry_.epoch_.load();
+
+    auto value = registry_.current_.load()->find(k);
+
+    if (value)
+        v = *value;
+
+    s.epoch.store(0, std::memory_order_release);
+
+    return value != nullptr;
+}
+
+/*!
+ * Constructor, the registry starts with an empty snapshot.
+ * \param readers Number of reader threads to be, there may be
+ *                no more than `max_readers` of them.
+ * \throw error If there are too many readers.
+ */
+tracker_registry::tracker_registry(std::size_t readers)
+{
+    /*
+     * Found out at start rather than when the last threads fail
+     * to take their slots.
+     */
+    if (readers > max_readers)
+        throw error("%zu tracker registry readers, %zu at most",
+                    readers, max_readers);
+
+    current_ = new id_table();
+}
+
+/*!
+ * Destructor.
+ */
+tracker_registry::~tracker_registry()
+{
+    delete current_.load();
+}
+
+/*!
+ * Publish a copy of the table as the latest snapshot. Must be called
+ * from the writer thread only.
+ * \param table
+ */
+void
+tracker_registry::publish(id_table const& table)
+{
+    std::unique_ptr<id_table const> copy { new id_table(table) };
+
+    /*
+     * Readers announcing the current epoch or an earlier one may still
+     * be in the old snapshot, the ones coming later are not.
+     */
+    retired_.push_back({
+        std::unique_ptr<id_table const> { current_.exchange(copy.release()) },
+        epoch_.fetch_add(1)
+    });
+
+    reclaim();
+}
+
+/*!
+ * Free replaced snapshots no reader is in. Must be called from
+ * the writer thread only.
+ * \return Number of snapshots still waiting for readers.
+ */
+std::size_t
+tracker_registry::reclaim()
+{
+    if (retired_.empty())
+        return 0;
+
+    /*
+     * The oldest epoch a reader is in, readers are outside most of
+     * the time.
+     */
+    uint64_t oldest = UINT64_MAX;
+
+    for (auto& s: slots_)
+    {
+        uint64_t e = s.epoch.load();
+
+        if (e)
+            oldest = std::min(oldest, e);
+    }
+
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [oldest](retired const& r)
+                                  {
+                                      return r.epoch < oldest;
+                                  }),
+                   retired_.end());
+
+    return retired_.size();
+}
+
+/*!
+ * Get a number of published snapshots.
+ * \return
+ */
+uint64_t
+tracker_registry::snapshots() const
+{
+    return epoch_ - 1;
+}
+
+} // namespace td
+} // namespace ys
@@ -7,6 +7,8 @@
 
 #include <ys/td/worker.h>
 
+#include <chrono>
+
 #include <ys/logger.h>
 #include <ys/td/parser.h>
 #include <ys/td/st270_parser.h>
@@ -45,7 +47,9 @@ worker::worker(config const& c, saver& s) :
 
     config_ { c },
 
-    saver_ { s }
+    saver_ { s },
+
+    ids_ { s.registry() }
 
 {
     /*
@@ -59,6 +63,8 @@ worker::worker(config const& c, saver& s) :
     on_connection_unregistered(
         boost::bind(&worker::on_conn_unreg, this, _1, _2)
     );
+
+    batch_.reserve(config_.data.saver.push_batch);
 }
 
 /*!
@@ -87,6 +93,7 @@ void
 worker::on_conn_unreg(ptr w, tcp_conn_ptr c)
 {
     sessions_.erase(c);
+    held_.erase(c);
 
     YS_LOG(debug) << "Connection lost";
 }
@@ -117,10 +124,21 @@ worker::on_conn_data(tcp_conn_ptr c, std::size_t s)
     }
 
     /*
-     * Load all arrived data into the parser.
+     * Load all arrived data into the parser, it is parsed right in
+     * the connection buffer.
      */
     p->load(c->buffer(), s);
 
+    /*
+     * Replies of a connection acknowledged after commit are collected
+     * and held until the reports of this read are committed. The list is
+     * kept alive in case the connection is dropped meanwhile.
+     */
+    auto held_it = held_.find(c);
+    auto replies = held_it != held_.end() ? held_it->second : nullptr;
+    parser::buffer_type reply;
+    uint32_t ticket = 0;
+
     /*
      * Do parsing while it's possible.
      */
@@ -132,7 +150,16 @@ worker::on_conn_data(tcp_conn_ptr c, std::size_t s)
          * Regardless of the parsing result send response if there is anything
          * to send.
          */
-        send_response(p, c);
+        if (replies)
+        {
+            auto& response = p->response();
+            reply.insert(reply.end(), response.begin(), response.end());
+            response.clear();
+        }
+        else
+        {
+            send_response(p, c);
+        }
 
         /*
          * Handle parsing result flags.
@@ -142,15 +169,69 @@ worker::on_conn_data(tcp_conn_ptr c, std::size_t s)
             continue;
 
         if (res.corrupt)
+        {
+            YS_LOG(debug) << "Corrupt data, connection dropped";
+
             unregister_connection(c);
+        }
 
         if (!res.parsed || res.corrupt)
             break;
 
         /*
-         * If we have reached this place then send parsed data to the database.
+         * Reports the saver would drop do not take queue space.
+         */
+        if (redundant(p->data()))
+            continue;
+
+        /*
+         * If we have reached this place then collect parsed data to send
+         * it to the database.
          */
-        saver_.push(p->data());
+        batch_.push_back(p->data());
+
+        if (replies)
+        {
+            if (!ticket)
+                ticket = open_ticket(c);
+
+            saver_.acks().retain(ticket);
+            batch_.back().ack = ticket;
+        }
+
+        if (batch_.size() >= config_.data.saver.push_batch)
+            saver_.push(batch_);
+    }
+
+    /*
+     * The connection buffer is reused by the next read, a message split
+     * between reads is kept by the parser.
+     */
+    p->detach();
+
+    /*
+     * Hand the rest of the reports from this read to the saver at once.
+     */
+    if (!batch_.empty())
+        saver_.push(batch_);
+
+    if (!replies)
+        return;
+
+    /*
+     * The reply is queued before the opener reference is dropped, the
+     * ticket handler never finds it missing. A reply acknowledging
+     * nothing still waits for the replies before it.
+     */
+    if (ticket)
+    {
+        replies->push_back({ ticket, std::move(reply), false });
+        saver_.acks().release(ticket);
+    }
+    else if (!reply.empty())
+    {
+        replies->push_back({ 0, std::move(reply), true });
+        send_ready(c, *replies);
     }
 }
 
@@ -229,6 +310,9 @@ worker::get_parser(tcp_conn_ptr c)
      */
     sessions_.insert({ c, parser });
 
+    if (port_it->second.ack_commit)
+        held_.insert({ c, std::make_shared<held_type>() });
+
     return parser;
 }
 
@@ -265,6 +349,142 @@ worker::send_response(parser_ptr p, tcp_conn_ptr c) const
     }
 }
 
+/*!
+ * Check whether the report needs not be saved, it is a keep-alive
+ * while tracker states are not kept, its tracker is known to be
+ * missing in a database or it is a retransmit of a saved one.
+ * \param d
+ * \return
+ */
+bool
+worker::redundant(report const& d)
+{
+    /*
+     * A keep-alive carries nothing but the tracker state, it is not
+     * worth a queue slot, a lookup or a spool record without one.
+     */
+    if (d.alive && config_.data.saver.state_table.empty())
+        return true;
+
+    id_table::value_type value;
+
+    if (!ids_.find({ d.number, d.number_size, d.type, d.sim }, value))
+        return false;
+
+    if (value.id == 0)
+    {
+        /*
+         * Expiration times are ticks of the saver clock.
+         */
+        auto now = std::chrono::steady_clock::now().time_since_epoch()
+                   .count();
+
+        if (value.expires <= now)
+            return false;
+
+        YS_LOG(debug) << "Dropped report of unknown tracker: " << d;
+
+        return true;
+    }
+
+    /*
+     * Trackers resend stored reports after reconnecting. A report is
+     * taken as a duplicate only once the original one is committed,
+     * so the retransmit is replied to right away.
+     */
+    if (!d.alive && saver_.duplicate(value.id, d))
+    {
+        YS_LOG(debug) << "Dropped retransmitted report: " << d;
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+ * Open a delivery ticket for reports of the connection.
+ * \param c Connection.
+ * \return
+ */
+uint32_t
+worker::open_ticket(tcp_conn_ptr c)
+{
+    /*
+     * The ticket is done by a saver or writer thread, the connection is
+     * handled back in the thread of this worker. The connection is not
+     * kept alive by the ticket.
+     */
+    auto& io = c->socket().get_io_service();
+    std::weak_ptr<tcp_conn_type> conn { c };
+
+    return saver_.acks().open([this, &io, conn](uint32_t ticket)
+    {
+        io.post([this, conn, ticket]()
+        {
+            on_ticket_done(conn, ticket);
+        });
+    });
+}
+
+/*!
+ * Mark a reply of the connection ready once its ticket is done.
+ * \param conn Connection, it may be lost by now.
+ * \param ticket Done ticket.
+ */
+void
+worker::on_ticket_done(std::weak_ptr<tcp_conn_type> conn, uint32_t ticket)
+{
+    auto c = conn.lock();
+
+    if (!c)
+        return;
+
+    auto held_it = held_.find(c);
+
+    if (held_it == held_.end())
+        return;
+
+    auto& replies = *held_it->second;
+
+    for (auto& r: replies)
+    {
+        if (r.ticket == ticket)
+        {
+            r.ready = true;
+            break;
+        }
+    }
+
+    send_ready(c, replies);
+}
+
+/*!
+ * Send ready replies of the connection up to the first held one.
+ * \param c Connection.
+ * \param replies Replies of the connection.
+ */
+void
+worker::send_ready(tcp_conn_ptr c, held_type& replies) const
+{
+    /*
+     * Replies go out in the order of reads, a tracker drops its buffered
+     * reports in the order they are acknowledged.
+     */
+    while (!replies.empty() && replies.front().ready)
+    {
+        if (!replies.front().bytes.empty())
+        {
+            c->write(replies.front().bytes,
+                     [](boost::system::error_code const& ec, size_t n)
+            {
+            });
+        }
+
+        replies.pop_front();
+    }
+}
+
 } // namespace td
 } // namespace ys
 
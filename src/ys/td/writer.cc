@@ -0,0 +1,862 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Database shard writer class source file.
+ */
+
+#include <ys/td/writer.h>
+
+#include <algorithm>
+#include <ctime>
+#include <thread>
+
+#include <ys/logger.h>
+#include <ys/td/row_fallback.h>
+
+namespace ys
+{
+namespace td
+{
+
+namespace
+{
+
+/*!
+ * Statement inserting a batch of reports, rows are unnested in the order
+ * of the arrays.
+ */
+const std::string batch_insert =
+    "select trackers.loginsert(id, "
+    "to_timestamp(dt) at time zone 'UTC', "
+    "lon / 1000000.0, lat / 1000000.0, "
+    "speed, odometer, course, sats_glonass, sats_gps) "
+    "from unnest($1::integer[], $2::bigint[], $3::integer[], "
+    "$4::integer[], $5::integer[], $6::bigint[], $7::integer[], "
+    "$8::integer[], $9::integer[]) "
+    "as s (id, dt, lon, lat, speed, odometer, course, "
+    "sats_glonass, sats_gps)";
+
+/*!
+ * Get array literals of the report columns of a range of rows, in the
+ * order of `batch_insert` parameters.
+ * \param first
+ * \param last
+ * \return
+ */
+template<typename Iterator>
+std::vector<std::string>
+to_arrays(Iterator first, Iterator last)
+{
+    std::vector<std::string> arrays(9);
+
+    for (auto it = first; it != last; ++it)
+    {
+        report const& d = it->second;
+
+        long long values[] =
+        {
+            it->first, d.datetime, d.lon, d.lat, d.speed, d.odometer,
+            d.course, d.sats_glonass, d.sats_gps
+        };
+
+        for (std::size_t i = 0; i < arrays.size(); ++i)
+        {
+            arrays[i] += it == first ? '{' : ',';
+            arrays[i] += std::to_string(values[i]);
+        }
+    }
+
+    for (auto& a: arrays)
+    {
+        a += '}';
+    }
+
+    return arrays;
+}
+
+} // namespace
+
+/*!
+ * Constructor.
+ * \param db Shard connections, not used in the asynchronous mode.
+ * \param shard Index of the shard connection in the pool.
+ * \param conn_str Connection string of the shard.
+ * \param opts Saver settings.
+ * \param acks Delivery tickets of reports waiting to be committed.
+ * \param spool Spool to move queued reports to when stopping,
+ *              nullptr if there is none.
+ * \param dedup Filter of retransmitted reports, committed reports
+ *              are added to it.
+ */
+writer::writer(ys::db::pool& db, std::size_t shard,
+               std::string const& conn_str,
+               config::saver_options const& opts, ack_table& acks,
+               spool* spool, dedup_window& dedup) :
+    db_ { db },
+    shard_ { shard },
+    conn_str_ { conn_str },
+    acks_ { acks },
+    spool_ { spool },
+    dedup_ { dedup },
+    opts_ { opts }
+{
+    /*
+     * The asynchronous mode opens connections of its own when started.
+     */
+    if (opts_.async)
+        return;
+
+    conn_ = db[shard];
+
+    if (opts_.copy)
+        copier_.reset(new copier(conn_str_, opts_.copy_merge));
+}
+
+/*!
+ * Declare statements used by writers on the pool connections.
+ * \param db
+ */
+void
+writer::prepare(ys::db::pool& db)
+{
+    /*
+     * Reports carry an epoch and integer coordinates, they are converted
+     * back to a timestamp and degrees by the server.
+     */
+    db.prepare("loginsert",
+               "select trackers.loginsert($1, "
+               "to_timestamp($2) at time zone 'UTC', "
+               "$3 / 1000000.0, $4 / 1000000.0, "
+               "$5, $6, $7, $8, $9)");
+
+    db.prepare("batch_insert", batch_insert);
+}
+
+/*!
+ * Start the writer process.
+ */
+void
+writer::run()
+{
+    batch_type batch;
+
+    batch.reserve(std::max(opts_.batch_size, opts_.bulk_batch_size));
+
+    /*!
+     * Lane of the batch.
+     */
+    lane l;
+
+    /*
+     * Live reports are always written first, backlog goes in larger
+     * batches when there are none.
+     */
+    while (queue_.pop(batch, opts_.batch_size, opts_.bulk_batch_size,
+                      batch_wait(), l))
+    {
+        /*
+         * A stopped writer does not keep on writing the rest of the queue,
+         * it is moved to the spool and saved after a restart.
+         */
+        if (interrupted_ && spill_queue(batch))
+            break;
+
+        /*
+         * While the shard is down the batch is kept and new reports wait
+         * in the queue, they are spooled, or given up if there is no
+         * spool, only if the writer is stopped before the shard is back.
+         */
+        bool saved = true;
+
+        while (!(park() && save(batch)))
+        {
+            if (interrupted_)
+            {
+                if (!spill_queue(batch))
+                {
+                    stats_.errors += batch.size();
+
+                    YS_LOG(error) << "Shard " << shard_ << " is down, " <<
+                                  batch.size() << " reports are lost";
+                }
+
+                saved = false;
+                break;
+            }
+        }
+
+        if (saved)
+        {
+            update_lag(l, batch);
+            release(batch);
+        }
+
+        batch.clear();
+    }
+}
+
+/*!
+ * Get time to wait for a live batch to fill up.
+ * \return
+ */
+std::chrono::milliseconds
+writer::batch_wait() const
+{
+    /*
+     * Replies to trackers wait for the commit, the group commit window
+     * is kept within the bound of the acknowledgement latency.
+     */
+    if (opts_.ack_latency > 0)
+        return std::chrono::milliseconds {
+                   std::min(opts_.batch_wait, opts_.ack_latency) };
+
+    return std::chrono::milliseconds { opts_.batch_wait };
+}
+
+/*!
+ * Start the writer on an event loop instead of running it
+ * in a dedicated thread.
+ * \param io Event loop.
+ */
+void
+writer::start(boost::asio::io_service& io)
+{
+    async_.reset(new ys::db::async_conn(io, conn_str_,
+                                        std::chrono::milliseconds {
+                                            opts_.reconnect_backoff }));
+    async_->prepare("batch_insert", batch_insert);
+    io_ = &io;
+
+    io.post([this]()
+    {
+        async_->open([this]()
+        {
+            resume();
+        });
+    });
+}
+
+/*!
+ * Interrupt execution once the queue is drained.
+ */
+void
+writer::interrupt()
+{
+    interrupted_ = true;
+    queue_.interrupt();
+
+    if (io_)
+    {
+        io_->post([this]()
+        {
+            kick();
+        });
+    }
+}
+
+/*!
+ * Get a number of reports waiting in the queue.
+ * \return
+ */
+std::size_t
+writer::depth() const
+{
+    return queue_.size();
+}
+
+/*!
+ * Get a number of reports waiting in a lane of the queue.
+ * \param l Lane.
+ * \return
+ */
+std::size_t
+writer::depth(lane l) const
+{
+    return queue_.size(l);
+}
+
+/*!
+ * Get writer statistics.
+ * \return
+ */
+writer::stats_type const&
+writer::stats() const
+{
+    return stats_;
+}
+
+/*!
+ * Get health of the shard connection.
+ * \return
+ */
+ys::db::pool::health_type const&
+writer::health() const
+{
+    return async_ ? async_->health() : db_.health(shard_);
+}
+
+/*!
+ * Save a batch of reports in a single transaction.
+ * \param batch Reports, the ones left unsaved when the connection
+ *              breaks stay in it.
+ * \return False if the connection is broken.
+ */
+bool
+writer::save(batch_type& batch)
+{
+    auto start = clock_type::now();
+
+    try
+    {
+        try
+        {
+            if (copier_)
+            {
+                copier_->save(batch.data(), batch.data() + batch.size());
+            }
+            else
+            {
+                /*!
+                 * Transaction.
+                 */
+                pqxx::work tx { *conn_ };
+
+                if (opts_.insert_chunk > 1)
+                {
+                    insert(tx, batch);
+                }
+                else
+                {
+                    for (auto& row: batch)
+                    {
+                        insert(tx, row);
+                    }
+                }
+
+                tx.commit();
+            }
+
+            remember(batch.begin(), batch.end());
+        }
+        catch (pqxx::broken_connection const&)
+        {
+            throw;
+        }
+        catch (pqxx::in_doubt_error const& e)
+        {
+            /*
+             * The connection was lost during the commit, the batch may
+             * be saved or not. It is sent again as a whole once the shard
+             * is back, saving it twice is better than losing reports
+             * whose trackers may have been replied to. Saving it row
+             * by row would not tell anything more.
+             */
+            YS_LOG(error) << "Shard " << shard_ << " commit of " <<
+                          batch.size() << " reports is in doubt: " <<
+                          e.what();
+
+            stats_.in_doubt += batch.size();
+
+            db_.broken(shard_);
+
+            return false;
+        }
+        catch (std::exception const& e)
+        {
+            YS_LOG(error) << "Failed to save a batch of " << batch.size() <<
+                          " reports: " << e.what();
+
+            /*
+             * Reports tried before the connection breaks are not sent
+             * again, their tickets are released here and the ones
+             * of the rest once they are saved.
+             */
+            save_row_by_row(batch, [this](row_type const& row)
+            {
+                pqxx::work tx { *conn_ };
+                insert(tx, row);
+                tx.commit();
+
+                dedup_.add(row.first, row.second);
+            },
+            [this](row_type& row, std::exception const& e)
+            {
+                ++stats_.errors;
+
+                YS_LOG(error) << "Failed to save report: " << e.what() <<
+                              ", " << row.second;
+
+                /*
+                 * A failed report would fail again if retransmitted,
+                 * its ticket is released at once like the ones of a failed
+                 * batch and is not released again with the batch.
+                 */
+                acks_.release(row.second.ack);
+                row.second.ack = 0;
+            },
+            [this](batch_type::const_iterator first,
+                   batch_type::const_iterator last)
+            {
+                acks_.release(first, last, [](row_type const& row)
+                              -> report const&
+                {
+                    return row.second;
+                });
+            });
+        }
+    }
+    catch (pqxx::broken_connection const& e)
+    {
+        YS_LOG(error) << "Shard " << shard_ << " connection is broken: " <<
+                      e.what();
+
+        db_.broken(shard_);
+
+        return false;
+    }
+
+    record(batch.size(), start);
+
+    return true;
+}
+
+/*!
+ * Remember committed reports so that their retransmits are dropped.
+ * \param first
+ * \param last
+ */
+void
+writer::remember(batch_type::const_iterator first,
+                 batch_type::const_iterator last)
+{
+    for (auto it = first; it != last; ++it)
+    {
+        dedup_.add(it->first, it->second);
+    }
+}
+
+/*!
+ * Update statistics with a committed batch.
+ * \param size Batch size.
+ * \param start Start time of the batch.
+ */
+void
+writer::record(std::size_t size, clock_type::time_point start)
+{
+    uint64_t time = std::chrono::duration_cast<std::chrono::microseconds>(
+                        clock_type::now() - start).count();
+
+    ++stats_.batches;
+    stats_.reports += size;
+    stats_.commit_time += time;
+    stats_.last_commit_time = time;
+
+    if (size > stats_.max_batch)
+        stats_.max_batch = size;
+
+    if (time > stats_.max_commit_time)
+        stats_.max_commit_time = time;
+}
+
+/*!
+ * Take the next batch of the queue and send it to the shard
+ * in the asynchronous mode.
+ */
+void
+writer::kick()
+{
+    /*
+     * While the shard is down the batch is kept and new reports wait
+     * in the queue, they are given up only if the writer is stopped
+     * before the shard is back.
+     */
+    if (!async_->health().healthy)
+    {
+        if (interrupted_)
+            drop();
+
+        return;
+    }
+
+    if (busy_)
+        return;
+
+    pending_.clear();
+
+    if (interrupted_ && spill_queue(pending_))
+    {
+        pending_.clear();
+        async_->close();
+
+        return;
+    }
+
+    if (!queue_.try_pop(pending_, opts_.batch_size, opts_.bulk_batch_size,
+                        pending_lane_))
+    {
+        /*
+         * The queue is drained, the event loop is let go.
+         */
+        if (interrupted_)
+            async_->close();
+
+        return;
+    }
+
+    busy_ = true;
+    single_ = false;
+    pos_ = 0;
+    start_ = clock_type::now();
+
+    send();
+}
+
+/*!
+ * Send pending reports to the shard in the asynchronous mode.
+ */
+void
+writer::send()
+{
+    auto first = pending_.begin() + pos_;
+    auto last = single_ ? first + 1 : pending_.end();
+
+    async_->exec("batch_insert", to_arrays(first, last),
+                 [this](std::exception_ptr e)
+    {
+        done(e);
+    });
+}
+
+/*!
+ * Handle a completion of pending reports in the asynchronous mode.
+ * \param e Error of the statement if any.
+ */
+void
+writer::done(std::exception_ptr e)
+{
+    try
+    {
+        if (e)
+            std::rethrow_exception(e);
+
+        auto first = pending_.begin() + pos_;
+
+        remember(first, single_ ? first + 1 : pending_.end());
+
+        if (single_ && ++pos_ < pending_.size())
+        {
+            send();
+            return;
+        }
+    }
+    catch (pqxx::broken_connection const& ex)
+    {
+        YS_LOG(error) << "Shard " << shard_ << " connection is broken: " <<
+                      ex.what();
+
+        /*
+         * Reports not saved yet are sent again once the connection
+         * is reopened. The statement runs in its own transaction, which
+         * the server may have committed before the connection broke,
+         * so its reports may be saved twice. That is better than losing
+         * reports whose trackers may have been replied to.
+         */
+        stats_.in_doubt += single_ ? 1 : pending_.size();
+
+        if (interrupted_)
+        {
+            drop();
+        }
+        else
+        {
+            async_->open([this]()
+            {
+                resume();
+            });
+        }
+
+        return;
+    }
+    catch (std::exception const& ex)
+    {
+        if (!single_)
+        {
+            YS_LOG(error) << "Failed to save a batch of " <<
+                          pending_.size() << " reports: " << ex.what();
+
+            /*
+             * Save the reports one by one so that a single bad report
+             * does not take the whole batch down with it.
+             */
+            single_ = true;
+            pos_ = 0;
+            send();
+
+            return;
+        }
+
+        ++stats_.errors;
+
+        YS_LOG(error) << "Failed to save report: " << ex.what() << ", " <<
+                      pending_[pos_].second;
+
+        if (++pos_ < pending_.size())
+        {
+            send();
+            return;
+        }
+    }
+
+    record(pending_.size(), start_);
+    update_lag(pending_lane_, pending_);
+    release(pending_);
+
+    busy_ = false;
+    kick();
+}
+
+/*!
+ * Continue writing once the shard connection is open.
+ */
+void
+writer::resume()
+{
+    if (busy_)
+        send();
+    else
+        kick();
+}
+
+/*!
+ * Spool the pending batch and queued reports, or give them up if
+ * there is no spool, when the writer is stopped while the shard
+ * is down.
+ */
+void
+writer::drop()
+{
+    batch_type batch;
+
+    /*
+     * Pending reports before the position are done, saved or failed.
+     */
+    if (busy_)
+    {
+        auto first = pending_.begin() + pos_;
+
+        acks_.release(pending_.begin(), first, [](row_type const& row)
+                      -> report const&
+        {
+            return row.second;
+        });
+
+        batch.assign(first, pending_.end());
+    }
+
+    pending_.clear();
+    busy_ = false;
+
+    if (!spill_queue(batch))
+    {
+        lane l;
+
+        while (queue_.try_pop(batch, SIZE_MAX, SIZE_MAX, l))
+        {
+        }
+
+        if (!batch.empty())
+        {
+            stats_.errors += batch.size();
+
+            YS_LOG(error) << "Shard " << shard_ << " is down, " <<
+                          batch.size() << " reports are lost";
+
+            release(batch);
+        }
+    }
+
+    async_->close();
+}
+
+/*!
+ * Move queued reports to the spool when the writer is stopped.
+ * \param batch Reports taken already, the queued ones are added
+ *              to them.
+ * \return False if there is no spool.
+ */
+bool
+writer::spill_queue(batch_type& batch)
+{
+    if (!spool_)
+        return false;
+
+    lane l;
+
+    while (queue_.try_pop(batch, SIZE_MAX, SIZE_MAX, l))
+    {
+    }
+
+    return spill(batch);
+}
+
+/*!
+ * Move reports to the spool instead of the shard.
+ * \param batch
+ * \return False if there is no spool.
+ */
+bool
+writer::spill(batch_type const& batch)
+{
+    if (!spool_)
+        return false;
+
+    std::size_t n = 0;
+
+    try
+    {
+        for (auto& row: batch)
+        {
+            spool_->push(row.second);
+            ++n;
+        }
+
+        spool_->sync();
+    }
+    catch (std::exception const& e)
+    {
+        YS_LOG(error) << "Failed to spool reports: " << e.what();
+    }
+
+    stats_.spooled += n;
+
+    if (n < batch.size())
+    {
+        stats_.errors += batch.size() - n;
+
+        YS_LOG(error) << "Shard " << shard_ << " writer is stopped, " <<
+                      batch.size() - n << " reports are lost";
+    }
+
+    release(batch);
+
+    return true;
+}
+
+/*!
+ * Update the lag of a lane with a committed batch.
+ * \param l Lane.
+ * \param batch
+ */
+void
+writer::update_lag(lane l, batch_type const& batch)
+{
+    if (batch.empty())
+        return;
+
+    int64_t newest = batch.front().second.datetime;
+
+    for (auto& row: batch)
+    {
+        newest = std::max(newest, row.second.datetime);
+    }
+
+    int64_t lag = std::time(nullptr) - newest;
+
+    if (l == lane::live)
+        stats_.live_lag = lag;
+    else
+        stats_.bulk_lag = lag;
+}
+
+/*!
+ * Release delivery tickets of a committed batch.
+ * \param batch
+ */
+void
+writer::release(batch_type const& batch)
+{
+    /*
+     * Reports failed to be saved are released too, they would fail again
+     * if retransmitted.
+     */
+    acks_.release(batch.begin(), batch.end(), [](row_type const& row)
+                  -> report const&
+    {
+        return row.second;
+    });
+}
+
+/*!
+ * Wait for the shard connection to be reopened.
+ * \return False if the writer was interrupted while waiting.
+ */
+bool
+writer::park()
+{
+    while (!db_.reconnect(shard_))
+    {
+        if (interrupted_)
+            return false;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+    }
+
+    return true;
+}
+
+/*!
+ * Execute an insert of the report.
+ * \param tx Transaction.
+ * \param row Report with resolved tracker id.
+ */
+void
+writer::insert(pqxx::work& tx, row_type const& row)
+{
+    uint32_t id = row.first;
+    report const& d = row.second;
+
+    tx.prepared("loginsert")
+        (id)
+        (d.datetime)
+        (d.lon)
+        (d.lat)
+        (static_cast<uint32_t>(d.speed))
+        (d.odometer)
+        (static_cast<int32_t>(d.course))
+        (static_cast<uint32_t>(d.sats_glonass))
+        (static_cast<uint32_t>(d.sats_gps))
+        .exec();
+}
+
+/*!
+ * Execute inserts of the batch with one statement per `insert_chunk`
+ * reports.
+ * \param tx Transaction.
+ * \param batch
+ */
+void
+writer::insert(pqxx::work& tx, batch_type const& batch)
+{
+    /*
+     * Reports go as bound arrays of a prepared statement, one round trip
+     * inserts a whole chunk. A failed chunk fails the transaction, and
+     * the batch is retried report by report to find the bad one.
+     */
+    for (auto first = batch.begin(); first != batch.end();)
+    {
+        auto last = first + std::min<std::size_t>(opts_.insert_chunk,
+                                                  batch.end() - first);
+
+        auto a = to_arrays(first, last);
+
+        tx.prepared("batch_insert")
+            (a[0])(a[1])(a[2])(a[3])(a[4])(a[5])(a[6])(a[7])(a[8])
+            .exec();
+
+        first = last;
+    }
+}
+
+} // namespace td
+} // namespace ys
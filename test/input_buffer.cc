@@ -0,0 +1,216 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Parser input buffer test.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ys/td/input_buffer.h>
+#include <ys/td/st270_parser.h>
+
+namespace
+{
+
+/*!
+ * Take complete `\r` terminated messages from the front of a buffer.
+ * \param b
+ * \param out Output messages, they are appended to it.
+ */
+void
+take_messages(ys::td::input_buffer& b, std::vector<std::string>& out)
+{
+    for (;;)
+    {
+        auto it = std::find(b.begin(), b.end(), '\r');
+
+        if (it == b.end())
+            return;
+
+        out.emplace_back(b.begin(), it);
+        b.consume(it + 1);
+    }
+}
+
+/*!
+ * Get a stream of numbered messages.
+ * \param n Number of messages.
+ * \param messages Output messages.
+ * \return The messages joined with delimiters.
+ */
+std::string
+make_stream(std::size_t n, std::vector<std::string>& messages)
+{
+    std::string stream;
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        messages.push_back("message " + std::to_string(i) +
+                           std::string(i % 13, '.'));
+
+        stream += messages.back() + '\r';
+    }
+
+    return stream;
+}
+
+/*!
+ * Messages split between reads are completed, whatever the read size,
+ * and the read buffer is reused for every read.
+ */
+void
+test_split_reads()
+{
+    std::vector<std::string> messages;
+    std::string stream = make_stream(200, messages);
+
+    for (std::size_t chunk = 1; chunk <= 64; ++chunk)
+    {
+        ys::td::input_buffer b;
+        std::vector<uint8_t> read(chunk);
+        std::vector<std::string> out;
+
+        for (std::size_t pos = 0; pos < stream.size(); pos += chunk)
+        {
+            std::size_t n = std::min(chunk, stream.size() - pos);
+
+            std::memcpy(read.data(), stream.data() + pos, n);
+
+            b.borrow(read.data(), n);
+            take_messages(b, out);
+            b.detach();
+
+            /*
+             * The next read overwrites the connection buffer.
+             */
+            std::fill(read.begin(), read.end(), 'x');
+        }
+
+        assert(out == messages);
+        assert(b.empty());
+    }
+}
+
+/*!
+ * Whole messages in a read are parsed in place and nothing is copied.
+ */
+void
+test_borrowed_in_place()
+{
+    std::string read = "first\rsecond\rthi";
+    auto p = reinterpret_cast<uint8_t const*>(read.data());
+
+    ys::td::input_buffer b;
+    std::vector<std::string> out;
+
+    b.borrow(p, read.size());
+
+    assert(b.data() == p);
+
+    take_messages(b, out);
+
+    assert(b.data() == p + 13);
+    assert(out.size() == 2);
+
+    b.detach();
+
+    assert(b.size() == 3);
+    assert(std::string(b.begin(), b.end()) == "thi");
+
+    read = "rd\r";
+    b.borrow(reinterpret_cast<uint8_t const*>(read.data()), read.size());
+    take_messages(b, out);
+
+    assert(out.back() == "third");
+    assert(b.empty());
+}
+
+/*!
+ * Appended bytes are kept in order while the front is consumed.
+ */
+void
+test_append_consume()
+{
+    std::vector<std::string> messages;
+    std::string stream = make_stream(1000, messages);
+
+    ys::td::input_buffer b;
+    std::vector<std::string> out;
+
+    for (std::size_t pos = 0; pos < stream.size(); pos += 7)
+    {
+        auto first = stream.begin() + pos;
+
+        b.append(first, first + std::min<std::size_t>(7, stream.size() - pos));
+        take_messages(b, out);
+    }
+
+    assert(out == messages);
+    assert(b.empty());
+
+    b.append(stream.begin(), stream.begin() + 10);
+    b.consume(100);
+
+    assert(b.empty());
+}
+
+/*!
+ * A report split between reads is parsed once it is complete.
+ */
+void
+test_split_report()
+{
+    const std::string packet =
+        "ST270STT;205000001;1097B;20161119;12:00:00;33e33;"
+        "+37.478628;-126.886030;000.012;123.40;9;7;1;120;0;0;15300;12.5;"
+        "001100;0;0;0;0;0;1;0\rST270ALV;205000002\r";
+
+    for (std::size_t split = 1; split < packet.size(); ++split)
+    {
+        ys::td::st270_parser parser;
+        std::vector<ys::td::report> reports;
+
+        for (auto part: { packet.substr(0, split), packet.substr(split) })
+        {
+            parser.load(part, part.size());
+
+            for (;;)
+            {
+                auto res = parser.parse();
+
+                if (!res.parsed)
+                    break;
+
+                reports.push_back(parser.data());
+            }
+
+            parser.detach();
+
+            std::fill(part.begin(), part.end(), 'x');
+        }
+
+        assert(reports.size() == 2);
+        assert(reports[0].get_number() == "205000001");
+        assert(reports[0].lat == 37478628);
+        assert(reports[1].alive);
+        assert(reports[1].get_number() == "205000002");
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    test_split_reads();
+    test_borrowed_in_place();
+    test_append_consume();
+    test_split_report();
+
+    return 0;
+}
@@ -0,0 +1,271 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Multi-producer single-consumer ring test.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <ys/td/mpsc_ring.h>
+
+namespace
+{
+
+/*!
+ * Ring typedef.
+ */
+using ring_type = ys::td::mpsc_ring<uint64_t>;
+
+/*!
+ * No wait for the first item.
+ */
+const std::chrono::milliseconds no_wait { 0 };
+
+/*!
+ * Positions wrap around the slots many times, items come out in order.
+ */
+void
+test_wraparound()
+{
+    ring_type ring { 8 };
+    std::vector<uint64_t> out;
+    uint64_t next = 0;
+
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        /*
+         * Odd counts make every push and pop straddle the end of slots.
+         */
+        for (uint64_t j = 0; j < 5; ++j)
+        {
+            assert(ring.push(i * 5 + j));
+        }
+
+        assert(ring.size() == 5);
+
+        out.clear();
+
+        assert(ring.pop(out, 5, no_wait));
+        assert(out.size() == 5);
+
+        for (auto v: out)
+        {
+            assert(v == next++);
+        }
+    }
+
+    assert(ring.size() == 0);
+}
+
+/*!
+ * A full ring takes nothing and gives all slots back once drained.
+ */
+void
+test_full()
+{
+    ring_type ring { 5 };
+
+    /*
+     * The capacity is rounded up to a power of two.
+     */
+    for (uint64_t i = 0; i < 8; ++i)
+    {
+        assert(ring.push(i));
+    }
+
+    assert(!ring.push(8));
+
+    std::vector<uint64_t> in { 8, 9, 10 };
+
+    assert(ring.push(in.begin(), in.end()) == 0);
+
+    std::vector<uint64_t> out;
+
+    assert(ring.pop(out, 100, no_wait));
+    assert(out.size() == 8);
+
+    assert(ring.push(in.begin(), in.end()) == 3);
+}
+
+/*!
+ * A range which does not fit is pushed in part, never past the free
+ * slots, the rest is pushed once there is room.
+ */
+void
+test_range_across_full()
+{
+    ring_type ring { 8 };
+    std::vector<uint64_t> out;
+
+    /*
+     * Move the positions so that the range wraps around the slots.
+     */
+    for (uint64_t i = 0; i < 6; ++i)
+    {
+        assert(ring.push(i));
+    }
+
+    assert(ring.pop(out, 6, no_wait));
+
+    for (uint64_t i = 0; i < 5; ++i)
+    {
+        assert(ring.push(100 + i));
+    }
+
+    std::vector<uint64_t> in;
+
+    for (uint64_t i = 0; i < 20; ++i)
+    {
+        in.push_back(200 + i);
+    }
+
+    auto it = in.begin();
+    std::size_t n = ring.push(it, in.end());
+
+    assert(n > 0 && n <= 3);
+
+    it += n;
+
+    out.clear();
+
+    while (it != in.end())
+    {
+        it += ring.push(it, in.end());
+
+        ring.pop(out, 3, no_wait);
+    }
+
+    while (ring.size())
+    {
+        assert(ring.pop(out, 100, no_wait));
+    }
+
+    /*
+     * Items keep the order they were pushed in.
+     */
+    std::vector<uint64_t> expected { 100, 101, 102, 103, 104 };
+
+    expected.insert(expected.end(), in.begin(), in.end());
+
+    assert(out == expected);
+}
+
+/*!
+ * Items of many producers arrive once each, in the order of every
+ * producer.
+ */
+void
+test_producers()
+{
+    const uint64_t producers = 4;
+    const uint64_t items = 100000;
+
+    ring_type ring { 64 };
+    std::vector<std::thread> threads;
+
+    for (uint64_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&ring, p, items]()
+        {
+            std::vector<uint64_t> batch;
+
+            for (uint64_t i = 0; i < items; )
+            {
+                /*
+                 * Single items and ranges are mixed.
+                 */
+                if (i % 3)
+                {
+                    if (ring.push(p << 32 | i))
+                        ++i;
+                    else
+                        std::this_thread::yield();
+
+                    continue;
+                }
+
+                batch.clear();
+
+                for (uint64_t j = i; j < i + 7 && j < items; ++j)
+                {
+                    batch.push_back(p << 32 | j);
+                }
+
+                std::size_t n = ring.push(batch.begin(), batch.end());
+
+                if (!n)
+                    std::this_thread::yield();
+
+                i += n;
+            }
+        });
+    }
+
+    std::vector<uint64_t> next(producers, 0);
+    std::vector<uint64_t> out;
+    uint64_t total = 0;
+
+    while (total < producers * items)
+    {
+        out.clear();
+
+        ring.pop(out, 16, std::chrono::milliseconds { 10 });
+
+        for (auto v: out)
+        {
+            uint64_t p = v >> 32;
+
+            assert(p < producers);
+            assert((v & 0xffffffff) == next[p]);
+
+            ++next[p];
+        }
+
+        total += out.size();
+    }
+
+    for (auto& t: threads)
+    {
+        t.join();
+    }
+
+    assert(ring.size() == 0);
+}
+
+/*!
+ * An interrupted ring hands out the rest of its items first.
+ */
+void
+test_interrupt()
+{
+    ring_type ring { 8 };
+    std::vector<uint64_t> out;
+
+    assert(ring.push(1));
+
+    ring.interrupt();
+
+    assert(ring.pop(out, 8, std::chrono::milliseconds { 1000 }));
+    assert(out.size() == 1);
+
+    assert(!ring.pop(out, 8, std::chrono::milliseconds { 1000 }));
+}
+
+} // namespace
+
+int
+main()
+{
+    test_wraparound();
+    test_full();
+    test_range_across_full();
+    test_producers();
+    test_interrupt();
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Row by row saving of a failed batch test.
+ */
+
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#include <pqxx/pqxx>
+#include <ys/td/row_fallback.h>
+
+namespace
+{
+
+/*!
+ * A row: a value and its delivery ticket.
+ */
+struct row
+{
+    /*!
+     * Value.
+     */
+    int value;
+
+    /*!
+     * Ticket, 0 once released.
+     */
+    int ticket;
+};
+
+/*!
+ * A connection breaking partway through the rows, rows tried before
+ * it broke are released once, saved or failed, and the rest stay
+ * in the batch.
+ */
+void
+test_broken_partway()
+{
+    std::vector<row> batch;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        batch.push_back({ i, i + 1 });
+    }
+
+    std::vector<int> saved, released;
+    bool thrown = false;
+
+    try
+    {
+        ys::td::save_row_by_row(batch, [&saved](row const& r)
+        {
+            if (r.value == 2)
+                throw std::runtime_error("bad report");
+
+            if (r.value == 5)
+                throw pqxx::broken_connection("connection lost");
+
+            saved.push_back(r.value);
+        },
+        [&released](row& r, std::exception const&)
+        {
+            released.push_back(r.ticket);
+            r.ticket = 0;
+        },
+        [&released](std::vector<row>::const_iterator first,
+                    std::vector<row>::const_iterator last)
+        {
+            for (auto it = first; it != last; ++it)
+            {
+                if (it->ticket)
+                    released.push_back(it->ticket);
+            }
+        });
+    }
+    catch (pqxx::broken_connection const&)
+    {
+        thrown = true;
+    }
+
+    assert(thrown);
+    assert((saved == std::vector<int> { 0, 1, 3, 4 }));
+
+    /*
+     * The failed row is released when it fails, the saved ones when
+     * the connection breaks, none twice.
+     */
+    assert((released == std::vector<int> { 3, 1, 2, 4, 5 }));
+
+    assert(batch.size() == 5);
+    assert(batch.front().value == 5);
+    assert(batch.back().value == 9);
+}
+
+/*!
+ * Without a broken connection every row is tried and nothing is released
+ * but failed rows.
+ */
+void
+test_all_tried()
+{
+    std::vector<row> batch { { 0, 1 }, { 1, 2 }, { 2, 3 } };
+    std::vector<int> failed;
+    std::size_t tried = 0;
+
+    ys::td::save_row_by_row(batch, [&tried](row const& r)
+    {
+        ++tried;
+
+        if (r.value == 1)
+            throw std::runtime_error("bad report");
+    },
+    [&failed](row& r, std::exception const&)
+    {
+        failed.push_back(r.value);
+    },
+    [](std::vector<row>::const_iterator, std::vector<row>::const_iterator)
+    {
+        assert(false);
+    });
+
+    assert(tried == 3);
+    assert(failed == std::vector<int> { 1 });
+    assert(batch.size() == 3);
+}
+
+} // namespace
+
+int
+main()
+{
+    test_broken_partway();
+    test_all_tried();
+
+    return 0;
+}
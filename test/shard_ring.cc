@@ -0,0 +1,170 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Consistent hash ring of database shards test.
+ */
+
+#include <cassert>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <ys/td/shard_ring.h>
+
+namespace
+{
+
+/*!
+ * Number of trackers placed.
+ */
+const uint32_t trackers = 100000;
+
+/*!
+ * Make shards of names.
+ * \param names
+ * \return
+ */
+std::vector<ys::td::config::db_shard>
+make_shards(std::vector<std::string> const& names)
+{
+    std::vector<ys::td::config::db_shard> shards;
+
+    for (auto& n: names)
+    {
+        ys::td::config::db_shard s;
+
+        s.conn = "dbname=" + n;
+        s.name = n;
+
+        shards.push_back(s);
+    }
+
+    return shards;
+}
+
+/*!
+ * Get a shard name of every tracker.
+ * \param shards
+ * \return
+ */
+std::vector<std::string>
+place(std::vector<ys::td::config::db_shard> const& shards)
+{
+    ys::td::shard_ring ring { shards };
+    std::vector<std::string> names;
+
+    for (uint32_t id = 1; id <= trackers; ++id)
+    {
+        std::size_t i = ring.shard(id);
+
+        assert(i < shards.size());
+
+        names.push_back(shards[i].name);
+    }
+
+    return names;
+}
+
+/*!
+ * Reordering shards in the config moves no trackers.
+ */
+void
+test_reorder()
+{
+    auto before = place(make_shards({ "a", "b", "c", "d" }));
+    auto after = place(make_shards({ "c", "a", "d", "b" }));
+
+    assert(before == after);
+}
+
+/*!
+ * Adding a shard moves about 1/N of trackers, all of them to the new
+ * shard.
+ */
+void
+test_add_shard()
+{
+    auto before = place(make_shards({ "a", "b", "c", "d" }));
+    auto after = place(make_shards({ "a", "b", "c", "d", "e" }));
+
+    uint32_t moved = 0;
+
+    for (uint32_t i = 0; i < trackers; ++i)
+    {
+        if (before[i] == after[i])
+            continue;
+
+        assert(after[i] == "e");
+
+        ++moved;
+    }
+
+    /*
+     * The new shard takes 1/5 of trackers give or take the spread
+     * of ring points.
+     */
+    assert(moved > trackers / 5 * 3 / 4);
+    assert(moved < trackers / 5 * 5 / 4);
+}
+
+/*!
+ * Trackers are spread in proportion to weights.
+ */
+void
+test_weights()
+{
+    auto shards = make_shards({ "a", "b", "c" });
+
+    shards[0].weight = 2;
+    shards[2].weight = 0;
+
+    uint32_t a = 0, b = 0;
+
+    for (auto& n: place(shards))
+    {
+        assert(n != "c");
+
+        a += n == "a";
+        b += n == "b";
+    }
+
+    assert(a + b == trackers);
+    assert(a > b * 3 / 2 && a < b * 5 / 2);
+}
+
+/*!
+ * Shards must have unique names and some weight.
+ */
+void
+test_invalid()
+{
+    for (auto shards: { make_shards({ "a", "b", "a" }), make_shards({}) })
+    {
+        bool thrown = false;
+
+        try
+        {
+            ys::td::shard_ring ring { shards };
+        }
+        catch (std::exception const&)
+        {
+            thrown = true;
+        }
+
+        assert(thrown);
+    }
+}
+
+} // namespace
+
+int
+main()
+{
+    test_reorder();
+    test_add_shard();
+    test_weights();
+    test_invalid();
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Durable reports spool test.
+ */
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <ys/td/spool.h>
+
+namespace
+{
+
+/*!
+ * Size of a spool segment.
+ */
+const std::size_t segment_size = 64 * 1024;
+
+/*!
+ * Make a report.
+ * \param number Tracker number.
+ * \param type Tracker type name.
+ * \return
+ */
+ys::td::report
+make_report(std::string const& number, std::string const& type)
+{
+    ys::td::report d;
+
+    d.set_number(number.data(), number.size());
+    d.type = ys::td::type_registry::intern(type);
+    d.datetime = 1479556800;
+    d.lat = 37478628;
+    d.lon = -126886030;
+
+    return d;
+}
+
+/*!
+ * Create an empty spool directory.
+ * \return
+ */
+std::string
+make_dir()
+{
+    char path[] = "/tmp/ys-td-spool-XXXXXX";
+
+    assert(mkdtemp(path));
+
+    return path;
+}
+
+/*!
+ * Remove a spool directory.
+ * \param dir
+ */
+void
+remove_dir(std::string const& dir)
+{
+    std::string cmd = "rm -rf '" + dir + "'";
+
+    assert(std::system(cmd.c_str()) == 0);
+}
+
+/*!
+ * Read reports are read again after a restart until they are committed.
+ */
+void
+test_replay_uncommitted()
+{
+    std::string dir = make_dir();
+
+    {
+        ys::td::spool s { dir, segment_size };
+
+        for (int i = 0; i < 10; ++i)
+        {
+            s.push(make_report("35000000" + std::to_string(i), "st270"));
+        }
+
+        s.sync();
+
+        std::vector<ys::td::report> out;
+        uint64_t mark;
+
+        assert(s.pop(out, 4, mark) == 4);
+        s.commit(mark);
+
+        assert(s.pop(out, 4, mark) == 4);
+        assert(s.size() == 2);
+    }
+
+    ys::td::spool s { dir, segment_size };
+    std::vector<ys::td::report> out;
+    uint64_t mark;
+
+    assert(s.size() == 6);
+    assert(s.pop(out, 100, mark) == 6);
+    assert(out.front().get_number() == "350000004");
+    assert(out.back().get_number() == "350000009");
+
+    remove_dir(dir);
+}
+
+/*!
+ * Type ids are assigned by every run in the order of first use, a report
+ * replayed by another run keeps its type name.
+ */
+void
+test_type_across_runs()
+{
+    std::string dir = make_dir();
+
+    /*
+     * The report is spooled by a child, which interns the types in its
+     * own order, this process does not know them yet.
+     */
+    pid_t pid = fork();
+
+    assert(pid >= 0);
+
+    if (pid == 0)
+    {
+        ys::td::type_registry::intern("m2m");
+
+        ys::td::spool s { dir, segment_size };
+
+        s.push(make_report("350000001", "st270"));
+        s.sync();
+
+        std::_Exit(ys::td::type_registry::name(2) == "st270" ? 0 : 1);
+    }
+
+    int status;
+
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    uint16_t st270 = ys::td::type_registry::intern("st270");
+    uint16_t irz = ys::td::type_registry::intern("irz");
+
+    assert(st270 == 1 && irz == 2);
+
+    ys::td::spool s { dir, segment_size };
+    std::vector<ys::td::report> out;
+    uint64_t mark;
+
+    assert(s.pop(out, 10, mark) == 1);
+    assert(out[0].type == st270);
+    assert(out[0].get_number() == "350000001");
+    assert(out[0].lat == 37478628);
+
+    remove_dir(dir);
+}
+
+} // namespace
+
+int
+main()
+{
+    /*
+     * Runs first, the types must not be interned yet.
+     */
+    test_type_across_runs();
+    test_replay_uncommitted();
+
+    return 0;
+}
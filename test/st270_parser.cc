@@ -0,0 +1,210 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  ST270 parser test.
+ */
+
+#include <cassert>
+#include <string>
+
+#include <ys/td/st270_parser.h>
+
+namespace
+{
+
+/*!
+ * Fields of a status report after the header and the tracker number.
+ */
+const std::string fields =
+    "1097B;20161119;12:00:00;33e33;"
+    "+37.478628;-126.886030;000.012;123.40;9;7;1;120;0;0;15300;12.5;"
+    "001100;0;0;0;0;0;1;0";
+
+/*!
+ * Parse one report line.
+ * \param line Report line without the delimiter.
+ * \param d Output report.
+ * \return
+ */
+ys::td::parser::result_type
+parse(std::string const& line, ys::td::report& d)
+{
+    ys::td::st270_parser parser;
+    const std::string packet = line + '\r';
+
+    parser.load(packet, packet.size());
+
+    auto res = parser.parse();
+
+    parser.detach();
+
+    d = parser.data();
+
+    return res;
+}
+
+/*!
+ * Get a status report with one field replaced.
+ * \param i Field index counted from the software version.
+ * \param value
+ * \return
+ */
+std::string
+with_field(std::size_t i, std::string const& value)
+{
+    std::string s = fields;
+    std::size_t first = 0;
+
+    for (; i; --i)
+    {
+        first = s.find(';', first) + 1;
+    }
+
+    std::size_t last = s.find(';', first);
+
+    s.replace(first, last == s.npos ? s.npos : last - first, value);
+
+    return "ST270STT;205000001;" + s;
+}
+
+/*!
+ * Fields are counted after the header and the tracker number. A parser
+ * counting them from the start of the line reads the date from
+ * the tracker number and parses no position report at all.
+ */
+void
+test_field_positions()
+{
+    ys::td::report d;
+
+    auto res = parse("ST270STT;205000001;" + fields, d);
+
+    assert(res.parsed && !res.corrupt);
+    assert(d.get_number() == "205000001");
+    assert(!d.alive);
+    assert(d.datetime == 1479556800);
+    assert(d.lat == 37478628);
+    assert(d.lon == -126886030);
+    assert(d.speed == 0);
+    assert(d.course == 123);
+    assert(d.sats_gps == 9);
+    assert(d.sats_glonass == 7);
+    assert(d.odometer == 15);
+}
+
+/*!
+ * Every report type with position data is read the same way.
+ */
+void
+test_report_types()
+{
+    for (auto hdr: { "ST270EMG", "ST270EVT", "ST270ALT" })
+    {
+        ys::td::report d;
+
+        assert(parse(std::string(hdr) + ";205000001;" + fields, d).parsed);
+        assert(d.lat == 37478628);
+    }
+
+    ys::td::report d;
+
+    assert(parse("ST270XXX;205000001;" + fields, d).corrupt);
+}
+
+/*!
+ * A report missing the last field is not read.
+ */
+void
+test_short_report()
+{
+    ys::td::report d;
+
+    std::string line = "ST270STT;205000001;" + fields;
+
+    line.erase(line.rfind(';'));
+
+    auto res = parse(line, d);
+
+    assert(!res.parsed && !res.corrupt);
+}
+
+/*!
+ * A keep-alive has the tracker number only.
+ */
+void
+test_alive()
+{
+    ys::td::report d;
+
+    auto res = parse("ST270ALV;205000001", d);
+
+    assert(res.parsed);
+    assert(d.alive);
+    assert(d.get_number() == "205000001");
+}
+
+/*!
+ * Values the report cannot hold are not truncated.
+ */
+void
+test_out_of_range()
+{
+    ys::td::report d;
+
+    assert(parse(with_field(4, "+90.000000"), d).parsed);
+    assert(d.lat == 90000000);
+
+    assert(!parse(with_field(4, "+90.000001"), d).parsed);
+    assert(!parse(with_field(5, "-180.0000005"), d).parsed);
+    assert(!parse(with_field(4, "12345678901234567890.5"), d).parsed);
+    assert(!parse(with_field(6, "65536"), d).parsed);
+    assert(!parse(with_field(7, "-1"), d).parsed);
+    assert(!parse(with_field(8, "256"), d).parsed);
+    assert(!parse(with_field(14, "-1000"), d).parsed);
+
+    assert(parse(with_field(6, "65535"), d).parsed);
+    assert(d.speed == 65535);
+}
+
+/*!
+ * A tracker number longer than a report holds fails the parse instead
+ * of being truncated into the number of another tracker.
+ */
+void
+test_long_number()
+{
+    ys::td::report d;
+    std::string number(ys::td::report::max_number, '7');
+
+    auto res = parse("ST270ALV;" + number, d);
+
+    assert(res.parsed);
+    assert(d.get_number() == number);
+
+    res = parse("ST270ALV;" + number + '8', d);
+
+    assert(!res.parsed);
+    assert(res.corrupt);
+
+    ys::td::report r;
+
+    assert(r.set_number("205000001"));
+    assert(!r.set_number(number + '8'));
+    assert(r.get_number() == "205000001");
+}
+
+} // namespace
+
+int
+main()
+{
+    test_field_positions();
+    test_report_types();
+    test_short_report();
+    test_alive();
+    test_out_of_range();
+    test_long_number();
+
+    return 0;
+}
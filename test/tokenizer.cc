@@ -0,0 +1,175 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Allocation free report tokenizer test.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+#include <ys/td/tokenizer.h>
+
+namespace
+{
+
+/*!
+ * Read a fraction, asserting it fits.
+ * \param s
+ * \param digits
+ * \return
+ */
+int64_t
+fixed(char const* s, unsigned digits)
+{
+    int64_t v = -1;
+
+    assert(ys::td::parse_fixed(s, digits, v));
+
+    return v;
+}
+
+/*!
+ * Get seconds since the epoch, -1 if the date or time is not valid.
+ * \param date
+ * \param time
+ * \return
+ */
+int64_t
+epoch(char const* date, char const* time)
+{
+    int64_t v = 0;
+
+    return ys::td::parse_epoch(date, time, v) ? v : -1;
+}
+
+/*!
+ * Fields are split at every delimiter, empty ones included, the last
+ * field holds the rest of a long line.
+ */
+void
+test_split()
+{
+    ys::td::tokenizer t { "a;;bc;", ';' };
+
+    assert(t.size() == 4);
+    assert(t[0] == "a");
+    assert(t[1].empty());
+    assert(t[2] == "bc");
+    assert(t[3].empty());
+    assert(t[4].empty());
+
+    std::string line;
+
+    for (std::size_t i = 0; i < ys::td::tokenizer::max_fields + 5; ++i)
+    {
+        line += std::to_string(i) + ';';
+    }
+
+    ys::td::tokenizer l { line, ';' };
+
+    assert(l.size() == ys::td::tokenizer::max_fields);
+    assert(l[l.size() - 2] == std::to_string(l.size() - 2));
+    assert(l[l.size() - 1].starts_with(std::to_string(l.size() - 1) + ';'));
+}
+
+/*!
+ * Fractions are rounded half away from zero, like `lround(x * 1e6)`.
+ */
+void
+test_rounding()
+{
+    assert(fixed("+37.4786285", 6) == 37478629);
+    assert(fixed("-37.4786285", 6) == -37478629);
+    assert(fixed("37.4786284", 6) == 37478628);
+    assert(fixed("-126.886030", 6) == -126886030);
+    assert(fixed("0.0000005", 6) == 1);
+    assert(fixed("-0.0000004", 6) == 0);
+    assert(fixed("12.5", 0) == 12);
+    assert(fixed("12", 6) == 12000000);
+    assert(fixed("12.", 6) == 12000000);
+    assert(fixed("1.99999999", 6) == 2000000);
+}
+
+/*!
+ * Integers are read the way a stream reads them.
+ */
+void
+test_int()
+{
+    int64_t v = -1;
+
+    assert(ys::td::parse_int("15.30", v) && v == 15);
+    assert(ys::td::parse_int("000.012", v) && v == 0);
+    assert(ys::td::parse_int("-42x", v) && v == -42);
+    assert(ys::td::parse_int("", v) && v == 0);
+    assert(ys::td::parse_int("x1", v) && v == 0);
+}
+
+/*!
+ * Values which do not fit are rejected, not wrapped.
+ */
+void
+test_overflow()
+{
+    int64_t v;
+
+    assert(fixed("9223372036854775807", 0) == INT64_MAX);
+    assert(fixed("-9223372036854775807", 0) == -INT64_MAX);
+
+    assert(!ys::td::parse_int("9223372036854775808", v));
+    assert(!ys::td::parse_fixed("12345678901234567890.5", 6, v));
+    assert(!ys::td::parse_fixed("9223372036854.775807", 7, v));
+    assert(!ys::td::parse_fixed("922337203685.47758075", 7, v));
+    assert(ys::td::parse_fixed("922337203685.47758074", 7, v));
+    assert(v == INT64_MAX);
+}
+
+/*!
+ * Dates and times are checked and converted in UTC.
+ */
+void
+test_epoch()
+{
+    assert(epoch("19700101", "00:00:00") == 0);
+    assert(epoch("20161119", "12:00:00") == 1479556800);
+    assert(epoch("19691231", "23:59:58") == -2);
+
+    /*
+     * Leap days.
+     */
+    assert(epoch("20160229", "00:00:00") == 1456704000);
+    assert(epoch("20160301", "00:00:00") == 1456790400);
+    assert(epoch("20000229", "00:00:00") == 951782400);
+    assert(epoch("21000229", "00:00:00") == -1);
+    assert(epoch("20170229", "00:00:00") == -1);
+
+    /*
+     * Malformed and out of range fields.
+     */
+    assert(epoch("20161119", "24:00:00") == -1);
+    assert(epoch("20161119", "12:60:00") == -1);
+    assert(epoch("20161119", "12:00:60") == -1);
+    assert(epoch("20161319", "12:00:00") == -1);
+    assert(epoch("20161100", "12:00:00") == -1);
+    assert(epoch("20160431", "12:00:00") == -1);
+    assert(epoch("2016111", "12:00:00") == -1);
+    assert(epoch("2016111x", "12:00:00") == -1);
+    assert(epoch("20161119", "12-00-00") == -1);
+    assert(epoch("13991231", "12:00:00") == -1);
+}
+
+} // namespace
+
+int
+main()
+{
+    test_split();
+    test_rounding();
+    test_int();
+    test_overflow();
+    test_epoch();
+
+    return 0;
+}
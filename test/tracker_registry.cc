@@ -0,0 +1,234 @@
+/*!
+ * \file
+ * \author agent <agent@local>
+ * \date   2026-10-17
+ * \brief  Tracker ids registry test.
+ */
+
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ys/td/tracker_registry.h>
+
+namespace
+{
+
+/*!
+ * Number of trackers in a snapshot.
+ */
+const std::size_t trackers = 1000;
+
+/*!
+ * Get a tracker number.
+ * \param i Tracker index.
+ * \return
+ */
+std::string
+number(std::size_t i)
+{
+    return "35" + std::to_string(1000000 + i);
+}
+
+/*!
+ * Fill a table with all trackers having the same id.
+ * \param numbers Tracker numbers, the table refers to them.
+ * \param id
+ * \param table
+ */
+void
+fill(std::vector<std::string> const& numbers, uint32_t id,
+     ys::td::id_table& table)
+{
+    for (auto& n: numbers)
+    {
+        auto value = table.insert({ n.data(), n.size(), 1, false });
+
+        assert(value);
+
+        value->id = id;
+        value->expires = 0;
+    }
+}
+
+/*!
+ * A reader sees every publication, a reader slot held outside a lookup
+ * does not hold snapshots back.
+ */
+void
+test_publish()
+{
+    std::vector<std::string> numbers;
+
+    for (std::size_t i = 0; i < trackers; ++i)
+    {
+        numbers.push_back(number(i));
+    }
+
+    ys::td::tracker_registry registry { 1 };
+    ys::td::tracker_registry::reader reader { registry };
+    ys::td::id_table::value_type value;
+
+    ys::td::id_table::key_type key { numbers[7].data(), numbers[7].size(),
+                                     1, false };
+
+    assert(!reader.find(key, value));
+
+    for (uint32_t id = 1; id <= 3; ++id)
+    {
+        ys::td::id_table table;
+
+        fill(numbers, id, table);
+        registry.publish(table);
+
+        assert(reader.find(key, value));
+        assert(value.id == id);
+        assert(registry.reclaim() == 0);
+    }
+
+    assert(registry.snapshots() == 3);
+}
+
+/*!
+ * Snapshots are replaced and reclaimed while readers are inside them,
+ * no reader ever sees a freed or an older snapshot. Run under a memory
+ * checker to catch a snapshot freed too early.
+ */
+void
+test_reclaim_under_readers()
+{
+    std::vector<std::string> numbers;
+
+    for (std::size_t i = 0; i < trackers; ++i)
+    {
+        numbers.push_back(number(i));
+    }
+
+    ys::td::tracker_registry registry { 4 };
+    std::atomic<bool> stop { false };
+    std::atomic<uint64_t> lookups { 0 };
+    std::vector<std::thread> readers;
+
+    {
+        ys::td::id_table table;
+
+        fill(numbers, 1, table);
+        registry.publish(table);
+    }
+
+    for (std::size_t r = 0; r < 4; ++r)
+    {
+        readers.emplace_back([&registry, &numbers, &stop, &lookups, r]()
+        {
+            ys::td::tracker_registry::reader reader { registry };
+            ys::td::id_table::value_type value;
+            uint32_t last = 0;
+
+            for (std::size_t i = r; !stop; i = (i + 1) % numbers.size())
+            {
+                auto& n = numbers[i];
+
+                assert(reader.find({ n.data(), n.size(), 1, false }, value));
+
+                /*
+                 * Snapshots only move forward for a reader.
+                 */
+                assert(value.id >= last);
+
+                last = value.id;
+                ++lookups;
+            }
+        });
+    }
+
+    uint32_t id = 2;
+
+    for (; id < 500 || lookups < 100000; ++id)
+    {
+        ys::td::id_table table;
+
+        fill(numbers, id, table);
+        registry.publish(table);
+        registry.reclaim();
+    }
+
+    stop = true;
+
+    for (auto& t: readers)
+    {
+        t.join();
+    }
+
+    /*
+     * With all readers gone every replaced snapshot is freed.
+     */
+    assert(registry.reclaim() == 0);
+    assert(registry.snapshots() == id - 1);
+}
+
+/*!
+ * Reader slots are limited and reused, a registry for more readers
+ * is not made.
+ */
+void
+test_reader_slots()
+{
+    ys::td::tracker_registry registry {
+        ys::td::tracker_registry::max_readers };
+
+    for (int round = 0; round < 2; ++round)
+    {
+        std::vector<std::unique_ptr<ys::td::tracker_registry::reader>> v;
+
+        for (std::size_t i = 0; i < registry.max_readers; ++i)
+        {
+            v.emplace_back(new ys::td::tracker_registry::reader(registry));
+        }
+
+        bool thrown = false;
+
+        try
+        {
+            ys::td::tracker_registry::reader extra { registry };
+        }
+        catch (std::exception const&)
+        {
+            thrown = true;
+        }
+
+        assert(thrown);
+    }
+
+    /*
+     * More reader threads than slots are refused at once.
+     */
+    bool thrown = false;
+
+    try
+    {
+        ys::td::tracker_registry too_many {
+            ys::td::tracker_registry::max_readers + 1 };
+    }
+    catch (std::exception const&)
+    {
+        thrown = true;
+    }
+
+    assert(thrown);
+}
+
+} // namespace
+
+int
+main()
+{
+    test_publish();
+    test_reclaim_under_readers();
+    test_reader_slots();
+
+    return 0;
+}